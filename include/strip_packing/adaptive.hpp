@@ -0,0 +1,157 @@
+#ifndef STRIP_PACKING_ADAPTIVE_HPP
+#define STRIP_PACKING_ADAPTIVE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace strip_packing::adaptive {
+
+/*! Limites e passos do controle adaptativo. */
+struct limits {
+    double max_mutation = 0.3; /// Fração máxima de mutantes extras
+    double min_shaking = 0.25; /// Fator mínimo da intensidade
+    double max_shaking = 2.0;  /// Fator máximo da intensidade
+    unsigned ipr_range = 8;    /// Razão máxima do intervalo do IPR
+    double smoothing = 0.3;    /// Peso da última janela na média
+};
+
+/**
+ * Controle adaptativo dos parâmetros do BRKGA durante a execução.
+ *
+ * O progresso é medido em janelas de tempo pela melhoria relativa do melhor
+ * custo por segundo, comparada a uma média móvel exponencial das janelas
+ * anteriores. Quando a taxa cai abaixo de metade da média (ou não há
+ * melhoria), o controlador diversifica a busca: aumenta a taxa de mutação
+ * extra e a intensidade das perturbações e chama o path-relinking com mais
+ * frequência. Quando a taxa passa da média, ele intensifica a busca: reduz
+ * a mutação extra e a intensidade das perturbações e espaça os
+ * path-relinkings.
+ *
+ * O controlador não depende da biblioteca do BRKGA: ele apenas sugere os
+ * parâmetros, que são aplicados pelo algoritmo (veja
+ * `heuristics::improvement::brkga_mp_ipr::set_adaptive`).
+ */
+class controller {
+  public:
+    /**
+     * Cria um controlador com janelas de `window` segundos, partindo do
+     * intervalo de path-relinking configurado (0 o mantém desabilitado).
+     */
+    controller(double window, unsigned ipr_interval, limits l = limits())
+        : m_limits(l), m_window(window), m_ipr_base(ipr_interval),
+          m_ipr_interval(ipr_interval), m_mutation(0), m_shaking(1),
+          m_reference(-1), m_window_start(0),
+          m_window_best(std::numeric_limits<double>::infinity()),
+          m_best(std::numeric_limits<double>::infinity()), m_adjustments(0) {}
+
+    /*! Registra uma nova melhor solução. O(1). */
+    void on_improvement(double best) { m_best = std::min(m_best, best); }
+
+    /**
+     * Registra o fim de uma geração no instante dado (em segundos desde o
+     * início) e, se a janela atual terminou, ajusta os parâmetros. Devolve
+     * se eles foram ajustados. O(1).
+     */
+    bool on_generation(double time) {
+        if (std::isinf(m_window_best)) {
+            m_window_start = time;
+            m_window_best = m_best;
+            return false;
+        }
+        double elapsed = time - m_window_start;
+        if (elapsed < m_window) {
+            return false;
+        }
+
+        double rate = 0;
+        if (m_best > 0 && std::isfinite(m_best)) {
+            rate = (m_window_best - m_best) / m_best / elapsed;
+        }
+        m_window_start = time;
+        m_window_best = m_best;
+
+        if (m_reference < 0) {
+            m_reference = rate;
+            return false;
+        }
+        if (rate <= 0 || rate < 0.5 * m_reference) {
+            diversify();
+        } else if (rate > m_reference) {
+            relax();
+        }
+        m_reference =
+            m_limits.smoothing * rate + (1 - m_limits.smoothing) * m_reference;
+        m_adjustments++;
+        return true;
+    }
+
+    /*! Fração de cada população a substituir por mutantes extras. */
+    double mutation() const { return m_mutation; }
+
+    /*! Fator aplicado à intensidade das perturbações. */
+    double shaking() const { return m_shaking; }
+
+    /*! Intervalo (em gerações) entre path-relinkings (0 se desabilitado). */
+    unsigned ipr_interval() const { return m_ipr_interval; }
+
+    /*! Número de janelas avaliadas. */
+    size_t adjustments() const { return m_adjustments; }
+
+    /**
+     * Tamanho de população para que o algoritmo faça cerca de `generations`
+     * gerações em `seconds` segundos, dado o tempo de uma decodificação e o
+     * número de threads entre as quais as decodificações são divididas,
+     * limitado a [`minimum`, `maximum`].
+     */
+    static unsigned population_size(double seconds, double decode_seconds,
+                                    unsigned threads, unsigned populations,
+                                    unsigned minimum, unsigned maximum,
+                                    unsigned generations = 500) {
+        maximum = std::max(minimum, maximum);
+        if (!std::isfinite(seconds) || decode_seconds <= 0) {
+            return maximum;
+        }
+        double size = seconds * std::max(1u, threads) /
+                      (double(generations) * populations * decode_seconds);
+        return unsigned(std::clamp(size, double(minimum), double(maximum)));
+    }
+
+  private:
+    limits m_limits;
+    double m_window;         /// Duração de cada janela (segundos)
+    unsigned m_ipr_base;     /// Intervalo configurado do IPR
+    unsigned m_ipr_interval; /// Intervalo atual do IPR
+    double m_mutation;       /// Fração de mutantes extras
+    double m_shaking;        /// Fator da intensidade das perturbações
+    double m_reference;      /// Média da taxa de melhoria (-1 se não há)
+    double m_window_start;   /// Início da janela atual
+    double m_window_best;    /// Melhor custo no início da janela
+    double m_best;           /// Melhor custo conhecido
+    size_t m_adjustments;
+
+    void diversify() {
+        m_mutation = std::min(m_limits.max_mutation,
+                              std::max(0.02, 1.5 * m_mutation));
+        m_shaking = std::min(m_limits.max_shaking, 1.25 * m_shaking);
+        if (m_ipr_base > 0) {
+            m_ipr_interval = std::max(
+                std::max(1u, m_ipr_base / m_limits.ipr_range),
+                m_ipr_interval / 2);
+        }
+    }
+
+    void relax() {
+        m_mutation = m_mutation < 0.02 ? 0 : 0.7 * m_mutation;
+        m_shaking = std::max(m_limits.min_shaking, 0.8 * m_shaking);
+        if (m_ipr_base > 0) {
+            m_ipr_interval =
+                std::min(m_ipr_base * m_limits.ipr_range, 2 * m_ipr_interval);
+        }
+    }
+};
+
+} // namespace strip_packing::adaptive
+
+#endif // STRIP_PACKING_ADAPTIVE_HPP
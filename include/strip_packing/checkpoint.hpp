@@ -0,0 +1,225 @@
+#ifndef STRIP_PACKING_CHECKPOINT_HPP
+#define STRIP_PACKING_CHECKPOINT_HPP
+
+#include "defs.hpp"
+
+#include "util/sort.hpp"
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace strip_packing::checkpoint {
+
+/**
+ * Ponto de restauração (checkpoint) das populações do BRKGA.
+ *
+ * Como os decodificadores só dependem da ordem relativa das chaves de cada
+ * cromossomo, cada cromossomo é armazenado de forma compacta como o vetor de
+ * posições (ranks) de cada retângulo na ordenação das chaves. Junto dos
+ * cromossomos é armazenada a tabela de retângulos da instância, de forma que
+ * o checkpoint pode ser usado para retomar a execução em uma instância
+ * ligeiramente modificada, com retângulos adicionados ou removidos.
+ *
+ * Formato binário (na ordem de bytes nativa):
+ *
+ *     "SPCK" | versão (u32) | n (u64) | n x (largura, altura, peso) (f64)
+ *     | número de cromossomos (u64) | para cada um: fitness (f64), n x u32
+ *
+ * Os cromossomos são gravados em ordem não decrescente de fitness, começando
+ * pelo incumbente.
+ */
+class snapshot {
+  public:
+    using rank_vector = std::vector<uint32_t>;
+
+  private:
+    static constexpr char MAGIC[4] = {'S', 'P', 'C', 'K'};
+    static constexpr uint32_t VERSION = 1;
+
+    std::vector<rect_t> m_rects;                         /// Retângulos
+    std::vector<std::pair<double, rank_vector>> m_ranks; /// Cromossomos
+
+    template <typename T> static void put(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T> static T get(std::istream& in) {
+        T value;
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+            throw std::runtime_error("truncated checkpoint file");
+        }
+        return value;
+    }
+
+    /*! Converte as chaves de um cromossomo em posições na ordenação. */
+    static rank_vector ranks(const BRKGA::Chromosome& chromosome) {
+        std::vector<size_t> permutation = util::sort_permutation(chromosome);
+        rank_vector rank(chromosome.size());
+        for (size_t i = 0; i < permutation.size(); i++) {
+            rank[permutation[i]] = i;
+        }
+        return rank;
+    }
+
+  public:
+    snapshot() = default;
+
+    /*! Captura um checkpoint do estado atual do algoritmo. */
+    template <typename Algorithm>
+    snapshot(const instance_t& instance, const Algorithm& brkga,
+             const BRKGA::BrkgaParams& params)
+        : m_rects(instance.rects) {
+        m_ranks.push_back(
+            {brkga.getBestFitness(), ranks(brkga.getBestChromosome())});
+        for (unsigned p = 0; p < params.num_independent_populations; p++) {
+            for (unsigned i = 0; i < params.population_size; i++) {
+                m_ranks.push_back({brkga.getFitness(p, i),
+                                   ranks(brkga.getChromosome(p, i))});
+            }
+        }
+        std::stable_sort(
+            m_ranks.begin(), m_ranks.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+    }
+
+    /*! Número de cromossomos armazenados. */
+    size_t size() const { return m_ranks.size(); }
+
+    /**
+     * Grava o checkpoint em um arquivo.
+     *
+     * O arquivo é escrito com outro nome e depois renomeado, para que uma
+     * interrupção durante a escrita não corrompa o checkpoint anterior.
+     */
+    void save(const std::string& filename) const {
+        std::string temporary = filename + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(MAGIC, sizeof(MAGIC));
+            put<uint32_t>(out, VERSION);
+            put<uint64_t>(out, m_rects.size());
+            for (const auto& rect : m_rects) {
+                put<double>(out, rect.length);
+                put<double>(out, rect.height);
+                put<double>(out, rect.weight);
+            }
+            put<uint64_t>(out, m_ranks.size());
+            for (const auto& [fitness, rank] : m_ranks) {
+                put<double>(out, fitness);
+                out.write(reinterpret_cast<const char*>(rank.data()),
+                          rank.size() * sizeof(uint32_t));
+            }
+            if (!out) {
+                throw std::runtime_error("failed to write checkpoint file " +
+                                         temporary);
+            }
+        }
+        if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+            throw std::runtime_error("failed to rename checkpoint file " +
+                                     temporary);
+        }
+    }
+
+    /*! Lê um checkpoint de um arquivo. */
+    static snapshot load(const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("cannot open checkpoint file " +
+                                     filename);
+        }
+
+        char magic[sizeof(MAGIC)];
+        if (!in.read(magic, sizeof(magic)) ||
+            !std::equal(magic, magic + sizeof(magic), MAGIC) ||
+            get<uint32_t>(in) != VERSION) {
+            throw std::runtime_error("invalid checkpoint file " + filename);
+        }
+
+        snapshot snap;
+        snap.m_rects.resize(get<uint64_t>(in));
+        for (auto& rect : snap.m_rects) {
+            rect.length = get<double>(in);
+            rect.height = get<double>(in);
+            rect.weight = get<double>(in);
+        }
+
+        size_t n = snap.m_rects.size();
+        snap.m_ranks.resize(get<uint64_t>(in));
+        for (auto& [fitness, rank] : snap.m_ranks) {
+            fitness = get<double>(in);
+            rank.resize(n);
+            if (!in.read(reinterpret_cast<char*>(rank.data()),
+                         n * sizeof(uint32_t))) {
+                throw std::runtime_error("truncated checkpoint file");
+            }
+        }
+        return snap;
+    }
+
+    /**
+     * Reconstrói até `limit` cromossomos para uma instância, que pode diferir
+     * da instância do checkpoint.
+     *
+     * Retângulos são associados por igualdade de dimensões e peso. Cada
+     * retângulo presente em ambas as instâncias mantém sua posição relativa
+     * na ordem de inserção, retângulos removidos são descartados, e
+     * retângulos novos recebem chaves aleatórias, sendo inseridos em posições
+     * aleatórias da ordem.
+     */
+    template <typename URBG>
+    std::vector<BRKGA::Chromosome> chromosomes(const instance_t& instance,
+                                               URBG&& rng,
+                                               size_t limit) const {
+        // Associa os retângulos antigos aos novos.
+        using key_t = std::tuple<dim_type, dim_type, cost_type>;
+        std::multimap<key_t, size_t> available;
+        for (size_t j = 0; j < instance.rects.size(); j++) {
+            const auto& rect = instance.rects[j];
+            available.insert({{rect.length, rect.height, rect.weight}, j});
+        }
+
+        std::vector<size_t> mapping(m_rects.size(), instance.rects.size());
+        for (size_t i = 0; i < m_rects.size(); i++) {
+            const auto& rect = m_rects[i];
+            auto it = available.find({rect.length, rect.height, rect.weight});
+            if (it != available.end()) {
+                mapping[i] = it->second;
+                available.erase(it);
+            }
+        }
+
+        std::uniform_real_distribution<> uniform(0, 1);
+        std::vector<BRKGA::Chromosome> result;
+        double n = m_rects.size();
+        for (size_t k = 0; k < m_ranks.size() && result.size() < limit; k++) {
+            const auto& rank = m_ranks[k].second;
+            BRKGA::Chromosome chromosome(instance.rects.size(), -1);
+            for (size_t i = 0; i < rank.size(); i++) {
+                if (mapping[i] < instance.rects.size()) {
+                    chromosome[mapping[i]] = (rank[i] + 0.5) / n;
+                }
+            }
+            for (auto& key : chromosome) {
+                if (key < 0) {
+                    key = uniform(rng);
+                }
+            }
+            result.push_back(std::move(chromosome));
+        }
+        return result;
+    }
+};
+
+} // namespace strip_packing::checkpoint
+
+#endif // STRIP_PACKING_CHECKPOINT_HPP
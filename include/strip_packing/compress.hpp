@@ -0,0 +1,302 @@
+#ifndef STRIP_PACKING_COMPRESS_HPP
+#define STRIP_PACKING_COMPRESS_HPP
+
+#include "defs.hpp"
+#include "reorder.hpp"
+
+#include "util/first_fit.hpp"
+#include "util/sort.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace strip_packing::compress {
+
+/*! Classe de retângulos idênticos. */
+struct rect_class {
+    rect_t rect;  /// Dimensões e peso dos retângulos da classe
+    size_t count; /// Multiplicidade
+};
+
+/**
+ * Parte de um nível de uma solução comprimida: um número de cópias de uma
+ * classe.
+ */
+struct class_run {
+    size_t index; /// Índice da classe
+    size_t count; /// Número de cópias
+};
+
+/*! Solução comprimida: cada nível é uma lista de cópias de classes. */
+using compressed_solution = std::vector<std::vector<class_run>>;
+
+/**
+ * Instância comprimida, com os retângulos idênticos (mesma largura, altura e
+ * peso) agrupados em classes com multiplicidade.
+ *
+ * Em instâncias com muitos retângulos repetidos, as heurísticas construtivas
+ * sobre a instância comprimida encaixam todas as cópias de uma classe que
+ * cabem em um nível de uma só vez, de forma que seu custo depende do número
+ * de classes e de níveis, e não do número de retângulos.
+ */
+struct compressed_instance {
+    std::vector<rect_class> classes;          /// Classes de retângulos
+    std::vector<std::vector<size_t>> members; /// Retângulos de cada classe
+    dim_type recipient_length;                /// Largura do recipiente
+
+    /*! Número total de retângulos. */
+    size_t rects() const {
+        size_t total = 0;
+        for (const auto& c : classes) {
+            total += c.count;
+        }
+        return total;
+    }
+
+    /*! Computa o custo de uma solução comprimida. O(tamanho da solução). */
+    cost_type cost(const compressed_solution& solution) const {
+        cost_type total = 0;
+        dim_type base = 0;
+        for (const auto& level : solution) {
+            dim_type level_height = 0;
+            cost_type level_weight = 0;
+            for (const auto& run : level) {
+                const auto& rect = classes[run.index].rect;
+                level_height = std::max(level_height, rect.height);
+                level_weight += rect.weight * run.count;
+            }
+            total += level_weight * base;
+            base += level_height;
+        }
+        return total;
+    }
+};
+
+/*! Agrupa os retângulos idênticos de uma instância. O(n lg n). */
+inline compressed_instance compress(const instance_t& instance) {
+    std::vector<size_t> order = util::sort_permutation(
+        instance.rects, [](const rect_t& a, const rect_t& b) {
+            return std::tie(a.length, a.height, a.weight) <
+                   std::tie(b.length, b.height, b.weight);
+        });
+
+    compressed_instance result;
+    result.recipient_length = instance.recipient_length;
+    for (size_t i = 0; i < order.size(); i++) {
+        const rect_t& rect = instance.rects[order[i]];
+        if (result.classes.empty() ||
+            std::tie(rect.length, rect.height, rect.weight) !=
+                std::tie(result.classes.back().rect.length,
+                         result.classes.back().rect.height,
+                         result.classes.back().rect.weight)) {
+            result.classes.push_back({rect, 0});
+            result.members.emplace_back();
+        }
+        result.classes.back().count++;
+        result.members.back().push_back(order[i]);
+    }
+    return result;
+}
+
+/**
+ * Expande uma solução comprimida em uma solução para a instância original.
+ * O(n).
+ *
+ * As cópias de cada classe são atribuídas aos retângulos da classe na ordem
+ * em que aparecem na solução.
+ */
+inline solution_t expand(const compressed_instance& instance,
+                         const compressed_solution& solution) {
+    std::vector<size_t> used(instance.classes.size(), 0);
+    solution_t expanded(solution.size());
+    for (size_t l = 0; l < solution.size(); l++) {
+        for (const auto& run : solution[l]) {
+            const auto& members = instance.members[run.index];
+            auto first = members.begin() + used[run.index];
+            expanded[l].insert(expanded[l].end(), first, first + run.count);
+            used[run.index] += run.count;
+        }
+    }
+    return expanded;
+}
+
+/**
+ * Reordena os níveis de uma solução comprimida de forma ótima (veja
+ * `reorder::smith`). O(L lg L + tamanho da solução).
+ */
+inline compressed_solution smith(const compressed_instance& instance,
+                                 compressed_solution solution) {
+    std::vector<reorder::level_summary> levels;
+    levels.reserve(solution.size());
+    for (const auto& level : solution) {
+        reorder::level_summary summary = {0, 0};
+        for (const auto& run : level) {
+            const auto& rect = instance.classes[run.index].rect;
+            summary.height = std::max(summary.height, rect.height);
+            summary.weight += rect.weight * run.count;
+        }
+        levels.push_back(summary);
+    }
+
+    compressed_solution ordered;
+    ordered.reserve(solution.size());
+    for (size_t l : reorder::smith_order(levels)) {
+        ordered.push_back(std::move(solution[l]));
+    }
+    return ordered;
+}
+
+namespace detail {
+
+/**
+ * Número de cópias de um retângulo de largura `length` que cabem em um
+ * espaço livre `free` (todas, caso a largura seja nula).
+ */
+inline size_t copies(dim_type free, dim_type length, size_t limit) {
+    if (length <= 0) {
+        return limit;
+    }
+    size_t k = std::min<size_t>(limit, size_t(free / length));
+    while (k > 0 && free - k * length < 0) {
+        k--;
+    }
+    return k;
+}
+
+/*! Abre novos níveis para as cópias de uma classe que não couberam. */
+template <typename F>
+inline void open_levels(const compressed_instance& instance, size_t index,
+                        size_t count, compressed_solution& solution,
+                        F&& on_open) {
+    dim_type L = instance.recipient_length;
+    dim_type len = instance.classes[index].rect.length;
+    size_t per_level = std::max<size_t>(1, copies(L, len, count));
+    while (count > 0) {
+        size_t k = std::min(count, per_level);
+        solution.push_back({{index, k}});
+        on_open(L - k * len);
+        count -= k;
+    }
+}
+
+} // namespace detail
+
+/**
+ * Next-fit sobre classes. O(c + m), onde c é o número de classes e m o
+ * número de níveis.
+ */
+inline compressed_solution next_fit(const compressed_instance& instance,
+                                    const std::vector<size_t>& permutation) {
+    compressed_solution solution;
+    dim_type free = 0;
+    for (size_t index : permutation) {
+        size_t count = instance.classes[index].count;
+        dim_type len = instance.classes[index].rect.length;
+        size_t k = solution.empty() ? 0 : detail::copies(free, len, count);
+        if (k > 0) {
+            solution.back().push_back({index, k});
+            free -= k * len;
+        }
+        detail::open_levels(instance, index, count - k, solution,
+                            [&](dim_type left) { free = left; });
+    }
+    return solution;
+}
+
+/**
+ * First-fit sobre classes, com `util::first_fit_tree::first_fit_n`.
+ * O((c + m) lg m).
+ */
+inline compressed_solution first_fit(const compressed_instance& instance,
+                                     const std::vector<size_t>& permutation) {
+    compressed_solution solution;
+    util::first_fit_tree<dim_type> levels;
+    for (size_t index : permutation) {
+        size_t count = instance.classes[index].count;
+        dim_type len = instance.classes[index].rect.length;
+        size_t left = levels.first_fit_n(len, count, [&](size_t l, size_t k) {
+            solution[l].push_back({index, k});
+        });
+        detail::open_levels(instance, index, left, solution,
+                            [&](dim_type free) { levels.push_back(free); });
+    }
+    return solution;
+}
+
+/*! Best-fit sobre classes. O((c + m) lg m). */
+inline compressed_solution best_fit(const compressed_instance& instance,
+                                    const std::vector<size_t>& permutation) {
+    compressed_solution solution;
+
+    // Como na heurística sobre retângulos, o nível de melhor encaixe é o de
+    // menor espaço livre dentre os que comportam o retângulo. Ele continua
+    // sendo o de melhor encaixe até não comportar mais nenhuma cópia, então
+    // todas as cópias que cabem nele são encaixadas de uma vez.
+    std::set<std::pair<dim_type, size_t>> levels;
+    for (size_t index : permutation) {
+        size_t count = instance.classes[index].count;
+        dim_type len = instance.classes[index].rect.length;
+        while (count > 0) {
+            auto it = levels.lower_bound({len, 0});
+            if (it == levels.end()) {
+                break;
+            }
+            auto [free, l] = *it;
+            size_t k = std::max<size_t>(1, detail::copies(free, len, count));
+            solution[l].push_back({index, k});
+            levels.erase(it);
+            levels.insert({free - k * len, l});
+            count -= k;
+        }
+        detail::open_levels(instance, index, count, solution,
+                            [&](dim_type free) {
+                                levels.insert({free, solution.size() - 1});
+                            });
+    }
+    return solution;
+}
+
+/**
+ * Heurística randomizada de first-fit em ordem decrescente de densidade sobre
+ * classes. Como em `heuristics::constructive`, o ruído é aplicado ao peso,
+ * mas uma única vez por classe.
+ */
+template <typename URBG, typename NoiseDist>
+compressed_solution
+randomized_first_fit_decreasing_density(const compressed_instance& instance,
+                                        URBG&& rng, NoiseDist noise) {
+    std::vector<rect_t> rects(instance.classes.size());
+    for (size_t i = 0; i < rects.size(); i++) {
+        rects[i] = instance.classes[i].rect;
+        rects[i].weight = std::max(0.0, rects[i].weight + noise(rng));
+    }
+    return first_fit(instance, util::sort_permutation(
+                                   rects, [](const auto& a, const auto& b) {
+                                       return a.weight * b.area() >
+                                              b.weight * a.area();
+                                   }));
+}
+
+/**
+ * Heurística randomizada de best-fit em ordem crescente de altura sobre
+ * classes. O ruído é aplicado à altura, uma única vez por classe.
+ */
+template <typename URBG, typename NoiseDist>
+compressed_solution
+randomized_best_fit_increasing_height(const compressed_instance& instance,
+                                      URBG&& rng, NoiseDist noise) {
+    std::vector<double> key(instance.classes.size());
+    for (size_t i = 0; i < key.size(); i++) {
+        key[i] = std::max(0.0, instance.classes[i].rect.height + noise(rng));
+    }
+    return best_fit(instance, util::sort_permutation(key));
+}
+
+} // namespace strip_packing::compress
+
+#endif // STRIP_PACKING_COMPRESS_HPP
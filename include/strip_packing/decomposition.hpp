@@ -0,0 +1,223 @@
+#ifndef STRIP_PACKING_DECOMPOSITION_HPP
+#define STRIP_PACKING_DECOMPOSITION_HPP
+
+#include "defs.hpp"
+#include "pipeline.hpp"
+#include "reorder.hpp"
+
+#include "util/deadline.hpp"
+#include "util/height_fit.hpp"
+#include "util/sort.hpp"
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strip_packing::decomposition {
+
+/**
+ * Solução por decomposição para instâncias muito grandes.
+ *
+ * Os retângulos são divididos em faixas de tamanhos iguais, consecutivas em
+ * ordem de densidade ou de altura, e cada faixa é resolvida como um
+ * subproblema independente pelo `pipeline::solve`, em paralelo. Assim, a
+ * memória da população e o tempo de decodificação do BRKGA dependem do
+ * tamanho das faixas, e não da instância toda.
+ *
+ * Os níveis das faixas são então juntados: cada nível é fundido a um nível
+ * anterior com espaço suficiente e altura maior ou igual, se houver (o que
+ * nunca aumenta o custo), e por fim os níveis são reordenados de forma
+ * ótima pela regra de Smith (veja `reorder`).
+ */
+
+/*! Critério de divisão em faixas. */
+enum class key {
+    density, /// Densidade (peso por área) decrescente
+    height,  /// Altura decrescente
+};
+
+/*! Lê um critério de divisão pelo nome. */
+inline key parse_key(const std::string& name) {
+    if (name == "density") {
+        return key::density;
+    } else if (name == "height") {
+        return key::height;
+    }
+    throw std::invalid_argument("invalid band key: " + name);
+}
+
+/*! Faixa da instância, resolvida como um subproblema. */
+struct band {
+    instance_t instance;     /// Retângulos da faixa
+    std::vector<size_t> ids; /// Índice original de cada retângulo
+};
+
+/*! Divide uma instância em faixas de tamanhos iguais. O(n lg n). */
+inline std::vector<band> split(const instance_t& instance, size_t count,
+                               key k) {
+    std::vector<size_t> order;
+    if (k == key::density) {
+        order = util::sort_permutation(
+            instance.rects, [](const auto& a, const auto& b) {
+                return a.weight * b.area() > b.weight * a.area();
+            });
+    } else {
+        order = util::sort_permutation(
+            instance.rects,
+            [](const auto& a, const auto& b) { return a.height > b.height; });
+    }
+
+    size_t n = order.size();
+    count = std::clamp<size_t>(count, 1, std::max<size_t>(n, 1));
+    std::vector<band> bands(count);
+    for (size_t b = 0; b < count; b++) {
+        bands[b].instance.recipient_length = instance.recipient_length;
+        for (size_t i = b * n / count; i < (b + 1) * n / count; i++) {
+            bands[b].ids.push_back(order[i]);
+            bands[b].instance.rects.push_back(instance.rects[order[i]]);
+        }
+    }
+    return bands;
+}
+
+/**
+ * Funde cada nível ao primeiro nível anterior com espaço livre suficiente e
+ * altura maior ou igual, caso exista. Como os retângulos do nível fundido
+ * descem e os níveis acima dele também, o custo nunca aumenta.
+ * O(L log H log L + n), com `util::height_fit_index`.
+ */
+inline solution_t merge_levels(const instance_t& instance,
+                               solution_t solution) {
+    std::vector<dim_type> heights, lengths;
+    heights.reserve(solution.size());
+    lengths.reserve(solution.size());
+    for (const auto& level : solution) {
+        dim_type height = 0, length = 0;
+        for (size_t i : level) {
+            height = std::max(height, instance.rects[i].height);
+            length += instance.rects[i].length;
+        }
+        heights.push_back(height);
+        lengths.push_back(length);
+    }
+
+    util::height_fit_index<dim_type> index(heights.begin(), heights.end(),
+                                           solution.size());
+    solution_t merged;
+    for (size_t l = 0; l < solution.size(); l++) {
+        size_t target = index.fit(lengths[l], heights[l]);
+        if (target != decltype(index)::npos) {
+            index.decrease(target, lengths[l]);
+            merged[target].insert(merged[target].end(), solution[l].begin(),
+                                  solution[l].end());
+        } else {
+            index.push_level(instance.recipient_length - lengths[l],
+                             heights[l]);
+            merged.push_back(std::move(solution[l]));
+        }
+    }
+    return merged;
+}
+
+/**
+ * Junta as soluções das faixas em uma solução da instância original,
+ * fundindo e reordenando os níveis.
+ */
+inline solution_t stitch(const instance_t& instance,
+                         const std::vector<band>& bands,
+                         const std::vector<solution_t>& solutions) {
+    solution_t solution;
+    for (size_t b = 0; b < bands.size(); b++) {
+        for (const auto& level : solutions[b]) {
+            std::vector<size_t> mapped;
+            mapped.reserve(level.size());
+            for (size_t i : level) {
+                mapped.push_back(bands[b].ids[i]);
+            }
+            solution.push_back(std::move(mapped));
+        }
+    }
+
+    // A fusão usa a ordem de Smith para priorizar níveis que ficam em baixo,
+    // e a ordem é refeita depois porque os pesos dos níveis mudam.
+    solution = reorder::smith(instance, std::move(solution));
+    solution = merge_levels(instance, std::move(solution));
+    return reorder::smith(instance, std::move(solution));
+}
+
+/*! Tempo de solução de cada faixa. */
+struct band_stats {
+    size_t rects;   /// Número de retângulos da faixa
+    double seconds; /// Tempo de solução (em segundos)
+    cost_type cost; /// Custo da solução da faixa, isolada
+};
+
+/**
+ * Resolve uma instância por decomposição em `count` faixas, com `threads`
+ * threads.
+ *
+ * As faixas são distribuídas dinamicamente entre as threads. Cada faixa
+ * recebe uma fração igual do tempo restante para as faixas ainda não
+ * iniciadas, considerando que `threads` faixas rodam ao mesmo tempo. As
+ * sementes das faixas são sorteadas antes, de forma que o resultado não
+ * depende do número de threads (a menos do prazo).
+ */
+template <typename URBG>
+solution_t solve(const instance_t& instance, size_t count, key k,
+                 unsigned threads, const pipeline::options& opts,
+                 const BRKGA::BrkgaParams& brkga_params,
+                 const BRKGA::ControlParams& control_params, URBG&& rng,
+                 const util::deadline& deadline,
+                 std::vector<band_stats>* stats = nullptr) {
+    std::vector<band> bands = split(instance, count, k);
+    std::vector<solution_t> solutions(bands.size());
+    std::vector<band_stats> band_times(bands.size());
+
+    std::vector<unsigned> seeds(bands.size());
+    for (auto& seed : seeds) {
+        seed = rng();
+    }
+
+    threads = std::max(1u, threads);
+    std::atomic<size_t> next(0);
+    auto worker = [&] {
+        for (size_t b = next++; b < bands.size(); b = next++) {
+            // Número de "rodadas" de faixas que ainda faltam, incluindo esta.
+            size_t rounds = (bands.size() - b + threads - 1) / threads;
+            util::deadline band_deadline = deadline.slice(1.0 / rounds);
+
+            util::deadline timer;
+            std::minstd_rand band_rng(seeds[b]);
+            solutions[b] = pipeline::solve(bands[b].instance, opts,
+                                           brkga_params, control_params,
+                                           band_rng, band_deadline);
+            band_times[b] = {bands[b].instance.rects.size(), timer.elapsed(),
+                             bands[b].instance.cost(solutions[b])};
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < std::min<size_t>(threads, bands.size()); t++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (stats) {
+        *stats = std::move(band_times);
+    }
+    return stitch(instance, bands, solutions);
+}
+
+} // namespace strip_packing::decomposition
+
+#endif // STRIP_PACKING_DECOMPOSITION_HPP
@@ -0,0 +1,139 @@
+#ifndef STRIP_PACKING_DISTANCE_HPP
+#define STRIP_PACKING_DISTANCE_HPP
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace strip_packing::distance {
+
+/**
+ * Conta as inversões de uma sequência (pares i < j com seq[i] > seq[j]) por
+ * merge sort, parando assim que a contagem atinge o limite dado. A
+ * sequência é ordenada (parcialmente, caso a contagem pare antes do fim).
+ * O(n lg n).
+ */
+inline uint64_t count_inversions(std::vector<uint32_t>& seq,
+                                 std::vector<uint32_t>& buffer,
+                                 uint64_t limit) {
+    size_t n = seq.size();
+    buffer.resize(n);
+
+    uint64_t count = 0;
+    for (size_t width = 1; width < n; width *= 2) {
+        for (size_t lo = 0; lo + width < n; lo += 2 * width) {
+            size_t mid = lo + width, hi = std::min(lo + 2 * width, n);
+            size_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                if (seq[j] < seq[i]) {
+                    // Todos os elementos restantes da metade esquerda formam
+                    // uma inversão com seq[j].
+                    count += mid - i;
+                    buffer[k++] = seq[j++];
+                } else {
+                    buffer[k++] = seq[i++];
+                }
+            }
+            std::copy(seq.begin() + i, seq.begin() + mid, buffer.begin() + k);
+            k += mid - i;
+            std::copy(seq.begin() + j, seq.begin() + hi, buffer.begin() + k);
+            std::copy(buffer.begin() + lo, buffer.begin() + hi,
+                      seq.begin() + lo);
+
+            if (count >= limit) {
+                return count;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * Distância de Kendall tau entre cromossomos, em O(n lg n).
+ *
+ * A distância é o número de pares de genes cuja ordem relativa difere entre
+ * os dois cromossomos, assim como na distância padrão da biblioteca (que é
+ * quadrática). Ela é calculada como o número de inversões da ordem de um
+ * cromossomo quando escrita em termos das posições dos genes na ordem do
+ * outro.
+ *
+ * A biblioteca só usa a distância para decidir se ela é pelo menos
+ * `pr_minimum_distance`, então a contagem é interrompida ao atingir esse
+ * limite, e o valor devolvido nesse caso é apenas uma cota inferior.
+ *
+ * É usada quando `pr_distance_function_type` é `CUSTOM`.
+ */
+class kendall_tau : public BRKGA::DistanceFunctionBase {
+  private:
+    double m_limit; /// Distância a partir da qual a contagem é interrompida
+
+    /*! Ordem dos genes de um cromossomo (empates pela posição). O(n lg n). */
+    static void argsort(const BRKGA::Chromosome& chromosome,
+                        std::vector<uint32_t>& order) {
+        order.resize(chromosome.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+            return chromosome[i] < chromosome[j] ||
+                   (chromosome[i] == chromosome[j] && i < j);
+        });
+    }
+
+  public:
+    kendall_tau(double limit = std::numeric_limits<double>::infinity())
+        : m_limit(limit) {}
+
+    double distance(const BRKGA::Chromosome& v1,
+                    const BRKGA::Chromosome& v2) const override {
+        // Vetores auxiliares reaproveitados entre chamadas, já que a
+        // biblioteca pode calcular distâncias em paralelo.
+        thread_local std::vector<uint32_t> order, rank, seq, buffer;
+
+        if (v1.size() < 2) {
+            return 0;
+        }
+
+        argsort(v2, order);
+        rank.resize(v2.size());
+        for (size_t k = 0; k < order.size(); k++) {
+            rank[order[k]] = k;
+        }
+
+        argsort(v1, order);
+        seq.resize(order.size());
+        for (size_t k = 0; k < order.size(); k++) {
+            seq[k] = rank[order[k]];
+        }
+
+        uint64_t limit = std::numeric_limits<uint64_t>::max();
+        if (m_limit < double(limit)) {
+            limit = uint64_t(std::max(0.0, std::ceil(m_limit)));
+        }
+        return double(count_inversions(seq, buffer, limit));
+    }
+
+    bool affectSolution(const BRKGA::Chromosome::value_type,
+                        const BRKGA::Chromosome::value_type) const override {
+        return true;
+    }
+
+    bool affectSolution(BRKGA::Chromosome::const_iterator v1_begin,
+                        BRKGA::Chromosome::const_iterator v2_begin,
+                        const std::size_t block_size) const override {
+        if (block_size == 1) {
+            return false;
+        }
+        BRKGA::Chromosome v1(v1_begin, v1_begin + block_size);
+        BRKGA::Chromosome v2(v2_begin, v2_begin + block_size);
+        return kendall_tau(1).distance(v1, v2) > 0;
+    }
+};
+
+} // namespace strip_packing::distance
+
+#endif // STRIP_PACKING_DISTANCE_HPP
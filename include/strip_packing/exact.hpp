@@ -0,0 +1,413 @@
+#ifndef STRIP_PACKING_EXACT_HPP
+#define STRIP_PACKING_EXACT_HPP
+
+#include "defs.hpp"
+#include "reorder.hpp"
+
+#include "util/sort.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace strip_packing::exact {
+
+/**
+ * Algoritmo exato de branch-and-bound sobre atribuições de retângulos a
+ * níveis, paralelizado com roubo de trabalho (work stealing).
+ *
+ * Os retângulos são processados em ordem decrescente de altura, de forma que
+ * a altura de cada nível é determinada pelo primeiro retângulo colocado nele.
+ * Cada nó da árvore de busca atribui o próximo retângulo a um nível existente
+ * em que ele cabe, ou a um nível novo. Como os níveis são tratados como um
+ * conjunto (não ordenado), o custo de uma partição é computado com os níveis
+ * na ordem ótima, isto é, em ordem decrescente da razão entre peso e altura
+ * (regra de Smith).
+ */
+class branch_and_bound {
+  public:
+    /*! Resultado da execução do algoritmo. */
+    struct result {
+        solution_t solution;   /// Melhor solução encontrada
+        cost_type cost;        /// Custo da melhor solução
+        cost_type lower_bound; /// Limitante inferior global
+        bool optimal;          /// Se a otimalidade foi provada
+        uint64_t nodes;        /// Número de nós explorados
+        double elapsed;        /// Tempo total (em segundos)
+        double time_to_best;   /// Tempo até a melhor solução (em segundos)
+    };
+
+  private:
+    /*! Resumo de um nível aberto em um nó da árvore de busca. */
+    struct level_t {
+        dim_type height;    /// Altura (fixa desde a abertura do nível)
+        dim_type remaining; /// Largura restante
+        cost_type weight;   /// Peso total
+    };
+
+    /*! Nó da árvore de busca. */
+    struct node_t {
+        size_t depth;                  /// Número de retângulos atribuídos
+        std::vector<level_t> levels;   /// Níveis abertos
+        std::vector<uint32_t> assigns; /// Nível de cada retângulo atribuído
+    };
+
+    /*! Fila de nós de um trabalhador. */
+    struct worker_queue {
+        std::mutex mutex;
+        std::deque<node_t> nodes;
+    };
+
+    using clock = std::chrono::steady_clock;
+
+    const instance_t& m_instance;
+
+    std::vector<size_t> m_order;     /// Ordem de processamento
+    std::vector<bool> m_same_as_prev; /// Se é idêntico ao retângulo anterior
+    std::vector<cost_type> m_suffix_bound; /// Limitante para os restantes
+
+    std::mutex m_incumbent_mutex;
+    std::atomic<cost_type> m_incumbent_cost;
+    std::vector<uint32_t> m_incumbent_assigns;
+    solution_t m_incumbent;
+    double m_time_to_best;
+
+    std::vector<worker_queue> m_queues;
+    std::atomic<uint64_t> m_pending;
+    std::atomic<uint64_t> m_nodes;
+    std::atomic<bool> m_stop;
+    clock::time_point m_start;
+
+    /**
+     * Custo de um conjunto de níveis dispostos na ordem ótima (veja
+     * `reorder::smith_cost`). O(L lg L).
+     *
+     * Os níveis são ordenados no próprio vetor, sem os índices auxiliares de
+     * `reorder::smith_order`, já que o custo é calculado a cada nó.
+     */
+    static cost_type ordered_cost(std::vector<level_t> levels) {
+        std::sort(levels.begin(), levels.end(),
+                  [](const level_t& a, const level_t& b) {
+                      return reorder::smith_ratio({a.height, a.weight}) <
+                             reorder::smith_ratio({b.height, b.weight});
+                  });
+        cost_type total = 0;
+        dim_type base = 0;
+        for (const auto& level : levels) {
+            total += level.weight * base;
+            base += level.height;
+        }
+        return total;
+    }
+
+    /*! Custo de uma partição com os níveis na ordem ótima. O(n + L lg L). */
+    cost_type partition_cost(const solution_t& partition) const {
+        std::vector<reorder::level_summary> levels;
+        levels.reserve(partition.size());
+        for (const auto& part : partition) {
+            reorder::level_summary level = {0, 0};
+            for (size_t i : part) {
+                level.height = std::max(level.height, m_instance.rects[i].height);
+                level.weight += m_instance.rects[i].weight;
+            }
+            levels.push_back(level);
+        }
+        return reorder::smith_cost(levels);
+    }
+
+    /*! Reconstrói a partição correspondente a uma atribuição completa. */
+    solution_t rebuild(const std::vector<uint32_t>& assigns) const {
+        solution_t partition;
+        for (size_t k = 0; k < assigns.size(); k++) {
+            if (assigns[k] >= partition.size()) {
+                partition.resize(assigns[k] + 1);
+            }
+            partition[assigns[k]].push_back(m_order[k]);
+        }
+        return reorder::smith(m_instance, std::move(partition));
+    }
+
+    /*! Limitante inferior para o custo de qualquer completação de um nó. */
+    cost_type lower_bound(const node_t& node) const {
+        return ordered_cost(node.levels) + m_suffix_bound[node.depth];
+    }
+
+    /*! Tenta atualizar a melhor solução conhecida. */
+    void offer_incumbent(const node_t& node, cost_type cost) {
+        std::lock_guard<std::mutex> lock(m_incumbent_mutex);
+        if (cost < m_incumbent_cost.load()) {
+            m_incumbent_assigns = node.assigns;
+            m_incumbent.clear();
+            m_incumbent_cost = cost;
+            m_time_to_best =
+                std::chrono::duration<double>(clock::now() - m_start).count();
+        }
+    }
+
+    /*! Determina se um limitante permite podar um nó. */
+    bool prune(cost_type bound) const {
+        cost_type incumbent = m_incumbent_cost.load(std::memory_order_relaxed);
+        return bound >= incumbent - 1e-9 * std::max(cost_type(1), incumbent);
+    }
+
+    void push(size_t worker, node_t&& node) {
+        m_pending++;
+        std::lock_guard<std::mutex> lock(m_queues[worker].mutex);
+        m_queues[worker].nodes.push_back(std::move(node));
+    }
+
+    /*! Remove um nó do fim da própria fila (busca em profundidade). */
+    bool pop_local(size_t worker, node_t& node) {
+        std::lock_guard<std::mutex> lock(m_queues[worker].mutex);
+        auto& nodes = m_queues[worker].nodes;
+        if (nodes.empty()) {
+            return false;
+        }
+        node = std::move(nodes.back());
+        nodes.pop_back();
+        return true;
+    }
+
+    /**
+     * Rouba um nó do início da fila de outro trabalhador.
+     *
+     * Os nós no início da fila são os mais rasos, e portanto correspondem às
+     * maiores subárvores disponíveis.
+     */
+    template <typename URBG> bool steal(size_t worker, node_t& node, URBG& rng) {
+        size_t W = m_queues.size();
+        size_t offset = std::uniform_int_distribution<size_t>(1, W)(rng);
+        for (size_t k = 0; k < W; k++) {
+            size_t victim = (worker + offset + k) % W;
+            if (victim == worker) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_queues[victim].mutex);
+            auto& nodes = m_queues[victim].nodes;
+            if (!nodes.empty()) {
+                node = std::move(nodes.front());
+                nodes.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*! Expande um nó, adicionando seus filhos promissores à fila. */
+    void expand(size_t worker, const node_t& node) {
+        if (prune(lower_bound(node))) {
+            return;
+        }
+
+        size_t k = node.depth;
+        if (k == m_order.size()) {
+            offer_incumbent(node, ordered_cost(node.levels));
+            return;
+        }
+
+        const rect_t& rect = m_instance.rects[m_order[k]];
+
+        // Regra de dominância para retângulos idênticos: qualquer solução
+        // pode ser reescrita de forma que retângulos idênticos consecutivos
+        // na ordem de processamento estejam em níveis de índice não
+        // decrescente.
+        size_t first = 0;
+        if (m_same_as_prev[k]) {
+            first = node.assigns[k - 1];
+        }
+
+        std::vector<std::pair<cost_type, node_t>> children;
+        for (size_t l = first; l <= node.levels.size(); l++) {
+            bool open = l == node.levels.size();
+            if (!open) {
+                const level_t& level = node.levels[l];
+                if (level.remaining < rect.length) {
+                    continue;
+                }
+
+                // Níveis com o mesmo estado levam a subárvores simétricas.
+                bool symmetric = false;
+                for (size_t m = first; m < l && !symmetric; m++) {
+                    const level_t& other = node.levels[m];
+                    symmetric = other.height == level.height &&
+                                other.remaining == level.remaining &&
+                                other.weight == level.weight;
+                }
+                if (symmetric) {
+                    continue;
+                }
+            }
+
+            node_t child = {k + 1, node.levels, node.assigns};
+            if (open) {
+                child.levels.push_back(
+                    {rect.height, m_instance.recipient_length, 0});
+            }
+            child.levels[l].remaining -= rect.length;
+            child.levels[l].weight += rect.weight;
+            child.assigns.push_back(l);
+
+            cost_type bound = lower_bound(child);
+            if (!prune(bound)) {
+                children.push_back({bound, std::move(child)});
+            }
+        }
+
+        // Os filhos com menor limitante são explorados primeiro.
+        std::sort(children.begin(), children.end(),
+                  [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (auto& [bound, child] : children) {
+            push(worker, std::move(child));
+        }
+    }
+
+    /*! Laço principal de um trabalhador. */
+    void work(size_t worker, double time_limit) {
+        std::minstd_rand rng(worker + 1);
+        node_t node;
+        uint64_t local_nodes = 0;
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            if (!pop_local(worker, node) && !steal(worker, node, rng)) {
+                if (m_pending.load() == 0) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            expand(worker, node);
+            m_pending--;
+
+            if (++local_nodes % 1024 == 0) {
+                m_nodes += 1024;
+                auto elapsed =
+                    std::chrono::duration<double>(clock::now() - m_start);
+                if (time_limit > 0 && elapsed.count() >= time_limit) {
+                    m_stop = true;
+                }
+            }
+        }
+        m_nodes += local_nodes % 1024;
+    }
+
+  public:
+    branch_and_bound(const instance_t& instance)
+        : m_instance(instance),
+          m_incumbent_cost(std::numeric_limits<cost_type>::infinity()),
+          m_time_to_best(0), m_pending(0), m_nodes(0), m_stop(false) {
+        const auto& rects = m_instance.rects;
+        size_t n = rects.size();
+
+        // Ordem decrescente de altura. Empates são quebrados pelos demais
+        // atributos, para que retângulos idênticos fiquem adjacentes.
+        m_order = util::sort_permutation(rects, [](const auto& a, const auto& b) {
+            if (a.height != b.height) {
+                return a.height > b.height;
+            }
+            if (a.length != b.length) {
+                return a.length > b.length;
+            }
+            return a.weight > b.weight;
+        });
+
+        m_same_as_prev.assign(n, false);
+        for (size_t k = 1; k < n; k++) {
+            const rect_t& a = rects[m_order[k - 1]];
+            const rect_t& b = rects[m_order[k]];
+            m_same_as_prev[k] = a.length == b.length &&
+                                a.height == b.height && a.weight == b.weight;
+        }
+
+        // Limitante para os retângulos ainda não atribuídos: no máximo um
+        // nível fica na base da pilha, e todos os demais estão a uma altura
+        // de pelo menos a menor altura da instância. Assim, o peso que não
+        // cabe em um único nível (pela relaxação fracionária da mochila)
+        // contribui com pelo menos essa altura.
+        dim_type min_height = n > 0 ? rects[m_order[n - 1]].height : 0;
+        m_suffix_bound.assign(n + 1, 0);
+        for (size_t k = 0; k < n; k++) {
+            std::vector<size_t> rest(m_order.begin() + k, m_order.end());
+            std::sort(rest.begin(), rest.end(), [&](size_t i, size_t j) {
+                return rects[i].weight * rects[j].length >
+                       rects[j].weight * rects[i].length;
+            });
+            cost_type outside = 0;
+            dim_type room = m_instance.recipient_length;
+            for (size_t i : rest) {
+                dim_type fit = std::clamp(room, dim_type(0), rects[i].length);
+                cost_type fraction =
+                    rects[i].length > 0 ? fit / rects[i].length : 1;
+                outside += rects[i].weight * (1 - fraction);
+                room -= fit;
+            }
+            m_suffix_bound[k] = outside * min_height;
+        }
+    }
+
+    /*! Define uma solução inicial (incumbente) para a busca. */
+    void set_incumbent(const solution_t& solution) {
+        cost_type cost = partition_cost(solution);
+        std::lock_guard<std::mutex> lock(m_incumbent_mutex);
+        if (cost < m_incumbent_cost.load()) {
+            m_incumbent = reorder::smith(m_instance, solution);
+            m_incumbent_assigns.clear();
+            m_incumbent_cost = cost;
+        }
+    }
+
+    /**
+     * Executa o algoritmo com um número dado de threads e um limite de tempo
+     * em segundos (0 significa sem limite).
+     */
+    result run(unsigned threads = 1, double time_limit = 0) {
+        threads = std::max(1u, threads);
+        m_start = clock::now();
+        m_stop = false;
+        m_nodes = 0;
+        m_queues = std::vector<worker_queue>(threads);
+
+        push(0, node_t{0, {}, {}});
+
+        std::vector<std::thread> workers;
+        for (unsigned w = 0; w < threads; w++) {
+            workers.emplace_back([this, w, time_limit] { work(w, time_limit); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        result res;
+        res.elapsed =
+            std::chrono::duration<double>(clock::now() - m_start).count();
+        res.nodes = m_nodes;
+        res.optimal = !m_stop && m_pending == 0;
+        res.cost = m_incumbent_cost;
+        res.time_to_best = m_time_to_best;
+        if (!m_incumbent_assigns.empty() || m_instance.rects.empty()) {
+            m_incumbent = rebuild(m_incumbent_assigns);
+        }
+        res.solution = m_incumbent;
+
+        // Sem a prova de otimalidade, o limitante global é o menor limitante
+        // dentre os nós que ficaram abertos.
+        res.lower_bound = res.cost;
+        for (auto& queue : m_queues) {
+            for (const auto& node : queue.nodes) {
+                res.lower_bound = std::min(res.lower_bound, lower_bound(node));
+            }
+        }
+        return res;
+    }
+};
+
+} // namespace strip_packing::exact
+
+#endif // STRIP_PACKING_EXACT_HPP
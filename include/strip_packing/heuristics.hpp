@@ -1,17 +1,38 @@
 #ifndef STRIP_PACKING_HEURISTICS_HPP
 #define STRIP_PACKING_HEURISTICS_HPP
 
+#include "adaptive.hpp"
+#include "checkpoint.hpp"
 #include "defs.hpp"
+#include "distance.hpp"
+#include "intensify.hpp"
+#include "island.hpp"
+#include "pool.hpp"
+#include "reorder.hpp"
+#include "trace.hpp"
 
+#include "util/deadline.hpp"
 #include "util/first_fit.hpp"
+#include "util/height_fit.hpp"
 #include "util/sort.hpp"
 
 #include <brkga_mp_ipr/brkga_mp_ipr.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <random>
 #include <set>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -44,6 +65,89 @@ static inline solution_t next_fit(const instance_t& instance,
     return solution;
 }
 
+/**
+ * Avaliação incremental do custo da heurística de next-fit, sem construir a
+ * solução. O(1) por retângulo.
+ *
+ * Como os retângulos seguintes nunca ficam abaixo do nível atual, o custo
+ * parcial mais o peso restante vezes a base do nível atual é uma cota
+ * inferior para o custo final, que permite interromper a avaliação cedo.
+ */
+class next_fit_cost {
+  private:
+    const instance_t& m_instance;
+    cost_type m_cost;             /// Custo dos retângulos já inseridos
+    cost_type m_remaining_weight; /// Peso dos retângulos restantes
+    dim_type m_base;              /// Altura da base do nível atual
+    dim_type m_height;            /// Altura do nível atual
+    dim_type m_used;              /// Largura ocupada no nível atual
+
+  public:
+    next_fit_cost(const instance_t& instance, cost_type total_weight)
+        : m_instance(instance), m_cost(0), m_remaining_weight(total_weight),
+          m_base(0), m_height(0), m_used(instance.recipient_length) {}
+
+    /*! Insere o próximo retângulo da ordem. */
+    void place(size_t j) {
+        const auto& rect = m_instance.rects[j];
+        m_used += rect.length;
+        if (m_used > m_instance.recipient_length) {
+            m_base += m_height;
+            m_height = 0;
+            m_used = rect.length;
+        }
+        m_height = std::max(m_height, rect.height);
+        m_cost += rect.weight * m_base;
+        m_remaining_weight -= rect.weight;
+    }
+
+    /*! Custo dos retângulos inseridos até agora (o custo final, ao fim). */
+    cost_type cost() const { return m_cost; }
+
+    /*! Cota inferior para o custo final. */
+    cost_type bound() const {
+        return m_cost + std::max<cost_type>(m_remaining_weight, 0) * m_base;
+    }
+};
+
+/**
+ * Avaliação incremental do custo da heurística de next-fit composta com a
+ * reordenação ótima dos níveis (veja `reorder`), sem construir a solução.
+ * O(1) por retângulo, mais O(L lg L) por cota ou custo calculado.
+ *
+ * O custo ótimo dos níveis parciais é uma cota inferior para o custo final,
+ * já que os níveis só crescem e novos níveis só são adicionados.
+ */
+class reordered_next_fit_cost {
+  private:
+    const instance_t& m_instance;
+    std::vector<reorder::level_summary> m_levels; /// Níveis até agora
+    dim_type m_used; /// Largura ocupada no nível atual
+
+  public:
+    reordered_next_fit_cost(const instance_t& instance, cost_type)
+        : m_instance(instance), m_used(instance.recipient_length) {}
+
+    /*! Insere o próximo retângulo da ordem. */
+    void place(size_t j) {
+        const auto& rect = m_instance.rects[j];
+        m_used += rect.length;
+        if (m_used > m_instance.recipient_length) {
+            m_levels.push_back({0, 0});
+            m_used = rect.length;
+        }
+        auto& level = m_levels.back();
+        level.height = std::max(level.height, rect.height);
+        level.weight += rect.weight;
+    }
+
+    /*! Custo ótimo dos níveis até agora (o custo final, ao fim). */
+    cost_type cost() const { return reorder::smith_cost(m_levels); }
+
+    /*! Cota inferior para o custo final. */
+    cost_type bound() const { return cost(); }
+};
+
 /**
  * Heurística construtiva determinística de first-fit. O(n lg n).
  */
@@ -123,6 +227,192 @@ static inline solution_t best_fit(const instance_t& instance,
     return solution;
 }
 
+/**
+ * Heurística construtiva determinística de encaixe por altura. O(n lg² n).
+ *
+ * Insere cada retângulo no nível mais baixo com espaço suficiente que ele não
+ * torna mais alto, ou, caso não exista nenhum, no nível com espaço suficiente
+ * cuja altura aumenta menos (veja `util::height_fit_index`). Caso nenhum
+ * nível tenha espaço, cria um novo nível.
+ */
+static inline solution_t height_fit(const instance_t& instance,
+                                    const std::vector<size_t>& permutation) {
+    solution_t solution;
+
+    std::vector<dim_type> heights;
+    heights.reserve(instance.rects.size());
+    for (const auto& rect : instance.rects) {
+        heights.push_back(rect.height);
+    }
+    util::height_fit_index<dim_type> levels(heights.begin(), heights.end(),
+                                            permutation.size());
+
+    for (size_t i = 0; i < permutation.size(); i++) {
+        size_t j = permutation[i];
+        const auto& rect = instance.rects[j];
+        size_t level = levels.find(rect.length, rect.height);
+        if (level != decltype(levels)::npos) {
+            levels.decrease(level, rect.length);
+            if (levels.height(level) < rect.height) {
+                levels.set_height(level, rect.height);
+            }
+            solution[level].push_back(j);
+        } else {
+            levels.push_level(instance.recipient_length - rect.length,
+                              rect.height);
+            solution.push_back({j});
+        }
+    }
+
+    return solution;
+}
+
+/*! Política de encaixe next-fit. O(n). */
+struct next_fit_policy {
+    static inline solution_t place(const instance_t& instance,
+                                   const std::vector<size_t>& permutation) {
+        return next_fit(instance, permutation);
+    }
+
+    using evaluator = next_fit_cost;
+    using reordered_evaluator = reordered_next_fit_cost;
+};
+
+/*! Política de encaixe first-fit, com `util::first_fit_tree`. O(n lg n). */
+struct first_fit_policy {
+    static inline solution_t place(const instance_t& instance,
+                                   const std::vector<size_t>& permutation) {
+        return first_fit(instance, permutation);
+    }
+};
+
+/*! Política de encaixe best-fit. O(n lg n). */
+struct best_fit_policy {
+    static inline solution_t place(const instance_t& instance,
+                                   const std::vector<size_t>& permutation) {
+        return best_fit(instance, permutation);
+    }
+};
+
+/*! Política de encaixe por altura, com `util::height_fit_index`. O(n lg² n). */
+struct height_fit_policy {
+    static inline solution_t place(const instance_t& instance,
+                                   const std::vector<size_t>& permutation) {
+        return height_fit(instance, permutation);
+    }
+};
+
+/*! Ordem decrescente de densidade (proporção entre peso e área). */
+struct decreasing_density_order {
+    static inline bool before(const rect_t& a, const rect_t& b) {
+        return a.weight * b.area() > b.weight * a.area();
+    }
+};
+
+/*! Ordem crescente de altura. */
+struct increasing_height_order {
+    static inline bool before(const rect_t& a, const rect_t& b) {
+        return a.height < b.height;
+    }
+};
+
+/*! Ordem decrescente de altura. */
+struct decreasing_height_order {
+    static inline bool before(const rect_t& a, const rect_t& b) {
+        return a.height > b.height;
+    }
+};
+
+/*! Ordem decrescente de peso. */
+struct decreasing_weight_order {
+    static inline bool before(const rect_t& a, const rect_t& b) {
+        return a.weight > b.weight;
+    }
+};
+
+/*! Sem ruído: a ordem é determinística. */
+struct no_noise {
+    static constexpr bool enabled = false;
+    static inline double value(const rect_t&) { return 0; }
+    static inline void apply(rect_t&, double) {}
+};
+
+/*! Ruído aplicado ao peso dos retângulos. */
+struct weight_noise {
+    static constexpr bool enabled = true;
+    static inline double value(const rect_t& rect) { return rect.weight; }
+    static inline void apply(rect_t& rect, double delta) {
+        rect.weight = std::max(0.0, rect.weight + delta);
+    }
+};
+
+/*! Ruído aplicado à altura dos retângulos. */
+struct height_noise {
+    static constexpr bool enabled = true;
+    static inline double value(const rect_t& rect) { return rect.height; }
+    static inline void apply(rect_t& rect, double delta) {
+        rect.height = std::max(0.0, rect.height + delta);
+    }
+};
+
+/**
+ * Heurística construtiva composta por políticas de ordenação, de ruído e de
+ * encaixe. O(n lg n) mais o custo do encaixe.
+ *
+ * O ruído é aplicado a uma cópia dos retângulos, que são ordenados pela
+ * política de ordenação; os retângulos (sem ruído) são então encaixados nessa
+ * ordem. Cada combinação de políticas é uma especialização separada, sem
+ * despacho dinâmico.
+ *
+ * @param Order - política de ordenação, com um método estático
+ *                `bool before(const rect_t&, const rect_t&)`.
+ * @param Noise - política de ruído (como `weight_noise`).
+ * @param Fit   - política de encaixe (como `first_fit_policy`).
+ */
+template <typename Order, typename Noise, typename Fit> struct engine {
+    /**
+     * Se as amostras variam com o ruído. Sem ruído, todas as amostras são
+     * iguais, e basta gerar uma.
+     */
+    static constexpr bool randomized = Noise::enabled;
+
+    /*! Desvio padrão do campo perturbado pelo ruído. O(n). */
+    static double spread(const instance_t& instance) {
+        if constexpr (!Noise::enabled) {
+            return 0;
+        } else {
+            if (instance.rects.empty()) {
+                return 0;
+            }
+            double mean = 0;
+            for (const auto& rect : instance.rects) {
+                mean += Noise::value(rect);
+            }
+            mean /= instance.rects.size();
+            double acc = 0;
+            for (const auto& rect : instance.rects) {
+                acc += std::pow(Noise::value(rect) - mean, 2);
+            }
+            return std::sqrt(acc / instance.rects.size());
+        }
+    }
+
+    /*! Gera uma solução, com ruído sorteado de `noise(rng)`. */
+    template <typename URBG, typename NoiseDist>
+    static solution_t sample(const instance_t& instance, URBG&& rng,
+                             NoiseDist&& noise) {
+        std::vector<rect_t> rects = instance.rects;
+        if constexpr (Noise::enabled) {
+            for (auto& rect : rects) {
+                Noise::apply(rect, noise(rng));
+            }
+        }
+        std::vector<size_t> permutation =
+            util::sort_permutation(rects, Order::before);
+        return Fit::place(instance, permutation);
+    }
+};
+
 /**
  * Heurística construtiva randomizada de first-fit em ordem decrescente da
  * proporção entre prioridade e altura. O(n lg n).
@@ -135,26 +425,26 @@ static inline solution_t best_fit(const instance_t& instance,
 template <typename URBG,
           typename NoiseDist = std::uniform_real_distribution<dim_type>>
 solution_t randomized_first_fit_decreasing_density(
-    instance_t instance, URBG&& rng,
+    const instance_t& instance, URBG&& rng,
     NoiseDist noise = std::uniform_real_distribution<>(-1.0, 1.0)) {
+    return engine<decreasing_density_order, weight_noise,
+                  first_fit_policy>::sample(instance, rng, noise);
+}
 
-    // Aplica ruído aos retângulos na instância.
-    // Isso não modifica a instância original, visto que ela é passada por cópia
-    // para a função da heurística.
-    for (auto& rect : instance.rects) {
-        rect.weight = std::max(0.0, rect.weight + noise(rng));
-    }
-
-    // Computamos um vetor de permutação para a ordenação por densidade.
-    // Isso é feito (no lugar de ordenar a lista de retângulos diretamente, por
-    // exemplo) para permitir referenciar a posição original de cada retângulo
-    // na instância original.
-    std::vector<size_t> permutation = util::sort_permutation(
-        instance.rects, [](const auto& a, const auto& b) {
-            return a.weight * b.area() > b.weight * a.area();
-        });
-
-    return first_fit(instance, permutation);
+/**
+ * Heurística construtiva randomizada de encaixe por altura em ordem
+ * decrescente da proporção entre prioridade e altura. O(n lg² n).
+ *
+ * Igual a `randomized_first_fit_decreasing_density`, mas usando
+ * `height_fit` no lugar do first-fit.
+ */
+template <typename URBG,
+          typename NoiseDist = std::uniform_real_distribution<dim_type>>
+solution_t randomized_height_fit_decreasing_density(
+    const instance_t& instance, URBG&& rng,
+    NoiseDist noise = std::uniform_real_distribution<>(-1.0, 1.0)) {
+    return engine<decreasing_density_order, weight_noise,
+                  height_fit_policy>::sample(instance, rng, noise);
 }
 
 /**
@@ -168,94 +458,524 @@ solution_t randomized_first_fit_decreasing_density(
 template <typename URBG,
           typename NoiseDist = std::uniform_real_distribution<dim_type>>
 solution_t randomized_best_fit_increasing_height(
-    instance_t instance, URBG&& rng,
+    const instance_t& instance, URBG&& rng,
     NoiseDist noise = std::uniform_real_distribution<>(-1.0, 1.0)) {
+    return engine<increasing_height_order, height_noise,
+                  best_fit_policy>::sample(instance, rng, noise);
+}
+
+/*! Nomes das políticas de encaixe (veja `with_fit`). */
+inline const std::vector<std::string> fit_names = {
+    "next-fit", "first-fit", "best-fit", "height-fit"};
 
-    // Aplica ruído aos retângulos na instância.
-    // Isso não modifica a instância original, visto que ela é passada por cópia
-    // para a função da heurística.
-    for (auto& rect : instance.rects) {
-        rect.height = std::max(0.0, rect.height + noise(rng));
+/*! Nomes das políticas de ordenação (veja `with_order`). */
+inline const std::vector<std::string> order_names = {
+    "density", "increasing-height", "decreasing-height", "weight"};
+
+/*! Nomes das políticas de ruído (veja `with_noise`). */
+inline const std::vector<std::string> noise_names = {"none", "weight",
+                                                     "height"};
+
+/**
+ * Chama `f.template operator()<Fit>()` com a política de encaixe de nome dado
+ * (um de `fit_names`).
+ */
+template <typename F> decltype(auto) with_fit(const std::string& name, F&& f) {
+    if (name == "next-fit") {
+        return f.template operator()<next_fit_policy>();
+    } else if (name == "first-fit") {
+        return f.template operator()<first_fit_policy>();
+    } else if (name == "best-fit") {
+        return f.template operator()<best_fit_policy>();
+    } else if (name == "height-fit") {
+        return f.template operator()<height_fit_policy>();
     }
+    throw std::invalid_argument("Unknown fit policy: " + name);
+}
 
-    // Computamos um vetor de permutação para a ordenação por peso.
-    // Isso é feito (no lugar de ordenar a lista de retângulos por peso
-    // diretamente, por exemplo) para permitir referenciar a posição original de
-    // cada retângulo na instância original.
-    std::vector<size_t> permutation = util::sort_permutation(
-        instance.rects,
-        [](const auto& a, const auto& b) { return a.height < b.height; });
+/**
+ * Chama `f.template operator()<Order>()` com a política de ordenação de nome
+ * dado (um de `order_names`).
+ */
+template <typename F>
+decltype(auto) with_order(const std::string& name, F&& f) {
+    if (name == "density") {
+        return f.template operator()<decreasing_density_order>();
+    } else if (name == "increasing-height") {
+        return f.template operator()<increasing_height_order>();
+    } else if (name == "decreasing-height") {
+        return f.template operator()<decreasing_height_order>();
+    } else if (name == "weight") {
+        return f.template operator()<decreasing_weight_order>();
+    }
+    throw std::invalid_argument("Unknown order policy: " + name);
+}
 
-    return best_fit(instance, permutation);
+/**
+ * Chama `f.template operator()<Noise>()` com a política de ruído de nome dado
+ * (um de `noise_names`).
+ */
+template <typename F>
+decltype(auto) with_noise(const std::string& name, F&& f) {
+    if (name == "none") {
+        return f.template operator()<no_noise>();
+    } else if (name == "weight") {
+        return f.template operator()<weight_noise>();
+    } else if (name == "height") {
+        return f.template operator()<height_noise>();
+    }
+    throw std::invalid_argument("Unknown noise policy: " + name);
+}
+
+/**
+ * Chama `f.template operator()<Engine>()` com a heurística construtiva de
+ * nome "FIT/ORDER/NOISE" (por exemplo, "first-fit/density/weight"). Todas as
+ * combinações de políticas são instanciadas.
+ */
+template <typename F>
+decltype(auto) with_heuristic(const std::string& name, F&& f) {
+    size_t first = name.find('/');
+    size_t second = name.find('/', first + 1);
+    if (first == std::string::npos || second == std::string::npos) {
+        throw std::invalid_argument("Invalid heuristic name: " + name);
+    }
+    std::string fit = name.substr(0, first);
+    std::string order = name.substr(first + 1, second - first - 1);
+    std::string noise = name.substr(second + 1);
+    return with_fit(fit, [&]<typename Fit>() -> decltype(auto) {
+        return with_order(order, [&]<typename Order>() -> decltype(auto) {
+            return with_noise(noise, [&]<typename Noise>() -> decltype(auto) {
+                return f.template operator()<engine<Order, Noise, Fit>>();
+            });
+        });
+    });
+}
+
+/*! Nomes de todas as heurísticas construtivas (veja `with_heuristic`). */
+inline std::vector<std::string> heuristic_names() {
+    std::vector<std::string> names;
+    for (const auto& fit : fit_names) {
+        for (const auto& order : order_names) {
+            for (const auto& noise : noise_names) {
+                names.push_back(fit + "/" + order + "/" + noise);
+            }
+        }
+    }
+    return names;
 }
 
 } // namespace constructive
 
 namespace improvement {
 
+/*! Estatísticas das decodificações limitadas (veja `permutation_decoder`). */
+struct decode_stats {
+    uint64_t decodes; /// Número de decodificações
+    uint64_t aborted; /// Decodificações interrompidas pelo limite
+    uint64_t placed;  /// Retângulos inseridos, somados entre decodificações
+    uint64_t skipped; /// Retângulos não inseridos por interrupções
+};
+
+/**
+ * Decodificador de solução a partir de um cromossomo.
+ *
+ * A solução determinada por um cromossomo é a obtida por uma heurística
+ * construtiva de encaixe, inserindo os retângulos por ordem crescente dos
+ * valores correspondentes a cada um no cromossomo (empates pela posição).
+ *
+ * A heurística é um parâmetro de template, de forma que cada decodificador é
+ * uma especialização separada, sem despacho dinâmico.
+ *
+ * Políticas que definem um avaliador incremental de custo (`evaluator`)
+ * admitem decodificação limitada: dado um limite (por exemplo, o pior custo
+ * da elite), a avaliação é interrompida assim que uma cota inferior para o
+ * custo passa dele, devolvendo essa cota como custo penalizado. Ela ainda é
+ * maior que o limite, então o cromossomo não entra na elite, e mantém uma
+ * ordem aproximada entre os demais. A ordem de inserção é ordenada aos
+ * poucos, em blocos de tamanho crescente separados com `std::nth_element`,
+ * de forma que uma interrupção também economiza parte da ordenação.
+ *
+ * @param Fit - política de encaixe, com um método estático
+ *              `solution_t place(const instance_t&, const std::vector<size_t>&)`
+ *              e, opcionalmente, um tipo `evaluator` (como
+ *              `constructive::next_fit_cost`).
+ */
+template <typename Fit> struct permutation_decoder {
+    instance_t m_instance;
+
+    permutation_decoder(instance_t instance)
+        : m_instance(instance), m_total_weight(0),
+          m_bound(std::make_shared<bound_state>()) {
+        for (const auto& rect : m_instance.rects) {
+            m_total_weight += rect.weight;
+        }
+    }
+
+    solution_t rebuild(const BRKGA::Chromosome& chromosome) const {
+        std::vector<size_t> permutation(chromosome.size());
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::sort(permutation.begin(), permutation.end(), order(chromosome));
+        return Fit::place(m_instance, permutation);
+    }
+
+    BRKGA::fitness_t decode(const BRKGA::Chromosome& chromosome, bool) const {
+        if constexpr (requires { typename Fit::evaluator; }) {
+            return evaluate(chromosome);
+        } else {
+            return m_instance.cost(rebuild(chromosome));
+        }
+    }
+
+    /*! Se o decodificador admite decodificação limitada. */
+    static constexpr bool bounded() {
+        return requires { typename Fit::evaluator; };
+    }
+
+    /**
+     * Define o limite das decodificações seguintes (infinito para
+     * desabilitar a interrupção).
+     */
+    void set_cutoff(double cutoff) {
+        m_bound->cutoff.store(cutoff, std::memory_order_relaxed);
+    }
+
+    /*! Estatísticas das decodificações até agora. */
+    decode_stats stats() const {
+        return {m_bound->decodes.load(), m_bound->aborted.load(),
+                m_bound->placed.load(), m_bound->skipped.load()};
+    }
+
+  private:
+    /*! Limite e contadores, compartilhados entre cópias e threads. */
+    struct bound_state {
+        std::atomic<double> cutoff = std::numeric_limits<double>::infinity();
+        std::atomic<uint64_t> decodes = 0, aborted = 0, placed = 0,
+                              skipped = 0;
+    };
+
+    cost_type m_total_weight;
+    std::shared_ptr<bound_state> m_bound;
+
+    /*! Comparador da ordem de inserção dos retângulos. */
+    static auto order(const BRKGA::Chromosome& chromosome) {
+        return [&chromosome](size_t i, size_t j) {
+            return chromosome[i] < chromosome[j] ||
+                   (chromosome[i] == chromosome[j] && i < j);
+        };
+    }
+
+    /*! Avaliação incremental e limitada do custo de um cromossomo. */
+    BRKGA::fitness_t evaluate(const BRKGA::Chromosome& chromosome) const {
+        thread_local std::vector<size_t> permutation;
+        size_t n = chromosome.size();
+        permutation.resize(n);
+        std::iota(permutation.begin(), permutation.end(), 0);
+
+        auto less = order(chromosome);
+        double cutoff = m_bound->cutoff.load(std::memory_order_relaxed);
+        typename Fit::evaluator evaluator(m_instance, m_total_weight);
+        m_bound->decodes.fetch_add(1, std::memory_order_relaxed);
+
+        // Sem limite, a ordem é ordenada de uma vez. Com limite, os blocos
+        // começam com 1/32 da instância e dobram de tamanho.
+        size_t begin = 0;
+        size_t end = std::isinf(cutoff) ? n : std::min<size_t>(n, 64 + n / 32);
+        while (begin < n) {
+            auto first = permutation.begin() + begin;
+            auto last = permutation.begin() + end;
+            if (end < n) {
+                std::nth_element(first, last, permutation.end(), less);
+            }
+            std::sort(first, last, less);
+            for (auto it = first; it != last; ++it) {
+                evaluator.place(*it);
+            }
+
+            if (end < n && evaluator.bound() > cutoff) {
+                m_bound->aborted.fetch_add(1, std::memory_order_relaxed);
+                m_bound->placed.fetch_add(end, std::memory_order_relaxed);
+                m_bound->skipped.fetch_add(n - end,
+                                           std::memory_order_relaxed);
+                return evaluator.bound();
+            }
+            begin = end;
+            end = std::min(n, 2 * end);
+        }
+        m_bound->placed.fetch_add(n, std::memory_order_relaxed);
+        return evaluator.cost();
+    }
+};
+
+using constructive::best_fit_policy;
+using constructive::first_fit_policy;
+using constructive::height_fit_policy;
+using constructive::next_fit_policy;
+
+/*! Avaliador incremental de uma política reordenada, se houver. */
+template <typename Fit> struct smith_evaluator {};
+
+template <typename Fit>
+    requires requires { typename Fit::reordered_evaluator; }
+struct smith_evaluator<Fit> {
+    using evaluator = typename Fit::reordered_evaluator;
+};
+
+/**
+ * Composição de uma política de encaixe com a reordenação ótima dos níveis
+ * (veja `reorder`). O(L lg L) a mais por decodificação.
+ */
+template <typename Fit> struct smith_policy : smith_evaluator<Fit> {
+    static inline solution_t place(const instance_t& instance,
+                                   const std::vector<size_t>& permutation) {
+        return reorder::smith(instance, Fit::place(instance, permutation));
+    }
+};
+
+using next_fit_decoder = permutation_decoder<next_fit_policy>;
+using first_fit_decoder = permutation_decoder<first_fit_policy>;
+using best_fit_decoder = permutation_decoder<best_fit_policy>;
+using height_fit_decoder = permutation_decoder<height_fit_policy>;
+
+/**
+ * Chama `f.template operator()<Decoder>()` com o decodificador da política de
+ * encaixe de nome dado (veja `constructive::with_fit`), composto com a
+ * reordenação ótima dos níveis caso `reordered`.
+ */
+template <typename F>
+decltype(auto) with_decoder(const std::string& name, bool reordered, F&& f) {
+    return constructive::with_fit(name, [&]<typename Fit>() -> decltype(auto) {
+        if (reordered) {
+            return f.template operator()<
+                permutation_decoder<smith_policy<Fit>>>();
+        }
+        return f.template operator()<permutation_decoder<Fit>>();
+    });
+}
+
 /**
  * Heurística de melhoria com BRKGA-MP-IPR.
  *
- * Recebe uma instância do problema e uma lista de soluções iniciais e melhora
+ * Recebe uma instância do problema e uma lista de soluções iniciais (na forma
+ * compacta de ordens de inserção, como em `pool::solution_pool`) e melhora
  * elas com um algoritmo genético de chave aleatória enviesado com múltiplos
  * pais e implicit path-relinking.
+ *
+ * @param Decoder - decodificador de cromossomos.
  */
-class brkga_mp_ipr {
+template <typename Decoder = next_fit_decoder> class brkga_mp_ipr {
   public:
-    brkga_mp_ipr(const instance_t& instance,
-                 const std::vector<solution_t>& initial)
-        : m_instance(instance), m_initial(initial) {}
+    using order_t = pool::solution_pool::order_t;
+
+    brkga_mp_ipr(const instance_t& instance, std::vector<order_t> initial)
+        : m_instance(instance), m_initial(std::move(initial)),
+          m_checkpoint_interval(0), m_bounded_decode(false),
+          m_intensify_workers(0), m_adaptive(false),
+          m_migration(nullptr), m_trace(nullptr), m_log(&std::cout) {}
 
     /*! Tamanho do cromossomo usado no algoritmo. */
     size_t chromosome_size() const { return m_instance.rects.size(); }
 
+    /**
+     * Define cromossomos (por exemplo, lidos de um checkpoint) que compõem a
+     * população inicial junto das soluções iniciais. Eles têm prioridade
+     * sobre as soluções iniciais caso não haja espaço para todos.
+     */
+    void set_warm_start(std::vector<BRKGA::Chromosome> chromosomes) {
+        m_warm_start = std::move(chromosomes);
+    }
+
+    /**
+     * Configura a gravação de checkpoints das populações em um arquivo, a
+     * cada intervalo dado (em segundos) e ao fim da execução.
+     */
+    void set_checkpoint(std::string filename, double interval) {
+        m_checkpoint_file = std::move(filename);
+        m_checkpoint_interval = interval;
+    }
+
+    /**
+     * Configura a troca de cromossomos de elite com outros processos. A cada
+     * `exchange_interval` iterações, os `num_exchange_individuals` melhores
+     * cromossomos são enviados aos pares, e os recebidos substituem os
+     * piores indivíduos das populações.
+     */
+    void set_migration(island::migration* migration) {
+        m_migration = migration;
+    }
+
+    /**
+     * Configura o registro da convergência do algoritmo: novas melhores
+     * soluções, estatísticas das populações a cada geração e perturbações.
+     */
+    void set_trace(trace::convergence_trace* trace) { m_trace = trace; }
+
+    /*! Ação executada a cada nova melhor solução encontrada. */
+    using observer = std::function<void(const BRKGA::AlgorithmStatus&)>;
+
+    /*! Configura uma ação executada a cada nova melhor solução. */
+    void set_observer(observer on_improvement) {
+        m_on_improvement = std::move(on_improvement);
+    }
+
+    /**
+     * Habilita a decodificação limitada (veja `permutation_decoder`), com o
+     * pior custo da elite das populações como limite, atualizado a cada
+     * geração. Não tem efeito em decodificadores que não a admitem.
+     */
+    void set_bounded_decode(bool enabled) { m_bounded_decode = enabled; }
+
+    /**
+     * Configura threads de intensificação que, durante a execução, aplicam
+     * busca local e ruína e recriação à melhor solução e a elites
+     * aleatórias, e devolvem os cromossomos melhorados às populações (veja
+     * `intensify::cooperative`).
+     */
+    void set_intensification(unsigned workers) {
+        m_intensify_workers = workers;
+    }
+
+    /**
+     * Habilita o controle adaptativo dos parâmetros (veja
+     * `adaptive::controller`): o tamanho das populações é ajustado ao tempo
+     * disponível antes da execução e, durante ela, mutantes extras, a
+     * intensidade das perturbações e o intervalo do path-relinking são
+     * ajustados conforme a taxa de melhoria.
+     */
+    void set_adaptive(bool enabled) { m_adaptive = enabled; }
+
+    /*! Define onde o progresso é escrito (nenhum lugar, se nulo). */
+    void set_log(std::ostream* log) { m_log = log; }
+
     /**
      * Executa o algoritmo com os parâmetros dados.
+     *
+     * A execução é interrompida ao fim da geração em que o prazo dado
+     * expirar, devolvendo a melhor solução encontrada até então.
      */
     template <typename URBG>
     solution_t run(URBG&& rng, BRKGA::BrkgaParams brkga_params,
                    BRKGA::ControlParams control_params,
-                   unsigned max_threads = 1) const {
-        next_fit_decoder decoder(m_instance);
+                   unsigned max_threads = 1,
+                   const util::deadline& deadline = util::deadline()) const {
+        Decoder decoder(m_instance);
+
+        progress_t progress;
+        std::unique_ptr<adaptive::controller> controller;
+        // O path-relinking também é chamado fora da biblioteca (veja
+        // `adapt`), então a função de distância é criada para qualquer tipo
+        // configurado.
+        using distance_type = BRKGA::PathRelinking::DistanceFunctionType;
+        if (brkga_params.pr_distance_function_type == distance_type::CUSTOM) {
+            brkga_params.pr_distance_function =
+                std::make_shared<distance::kendall_tau>(
+                    brkga_params.pr_minimum_distance);
+        } else if (brkga_params.pr_distance_function_type ==
+                   distance_type::HAMMING) {
+            brkga_params.pr_distance_function =
+                std::make_shared<BRKGA::HammingDistance>();
+        } else {
+            brkga_params.pr_distance_function =
+                std::make_shared<BRKGA::KendallTauDistance>();
+        }
+
+        // O limite de tempo da biblioteca tem resolução de segundos, então
+        // ele é apenas arredondado para cima, e o prazo exato é verificado a
+        // cada iteração.
+        if (deadline.bounded()) {
+            auto remaining = std::chrono::seconds(
+                (long long)std::ceil(deadline.remaining()));
+            control_params.maximum_running_time =
+                std::min(control_params.maximum_running_time, remaining);
+        }
 
-        brkga_params.custom_shaking = shaking_function(rng, decoder);
+        // O path-relinking passa a ser chamado pelo controlador, no
+        // intervalo ajustado por ele.
+        if (m_adaptive) {
+            double budget =
+                std::min(deadline.remaining(),
+                         double(control_params.maximum_running_time.count()));
+            size_populations(decoder, brkga_params, budget, max_threads);
+            controller = std::make_unique<adaptive::controller>(
+                std::clamp(budget / 40, 0.2, 30.0),
+                control_params.ipr_interval);
+            control_params.ipr_interval = 0;
+        }
+        brkga_params.custom_shaking =
+            shaking_function(rng, decoder, progress, controller.get());
 
         algorithm brkga(decoder, BRKGA::Sense::MINIMIZE, rng(),
                         chromosome_size(), brkga_params, max_threads);
 
-        set_initial_population(brkga);
-        observe_solution_progress(brkga);
+        set_initial_population(brkga, brkga_params);
+        observe_solution_progress(brkga, progress);
+
+        std::unique_ptr<intensify::cooperative<Decoder>> cooperative;
+        if (m_intensify_workers > 0) {
+            cooperative = std::make_unique<intensify::cooperative<Decoder>>(
+                m_instance, decoder,
+                [this](const solution_t& s) { return encode(s); },
+                m_intensify_workers, rng());
+        }
+
+        // Ações executadas ao fim de cada iteração. Qualquer uma delas pode
+        // pedir a interrupção do algoritmo.
+        std::vector<iteration_hook> hooks;
+        trace_generations(brkga, brkga_params, progress, hooks);
+        stop_on_deadline(hooks, deadline);
+        cooperate(brkga, brkga_params, cooperative.get(), rng(), hooks);
+        adapt(brkga, brkga_params, controller.get(), rng(), hooks);
+        save_checkpoints(brkga, brkga_params, hooks);
+        migrate(brkga, brkga_params, control_params, hooks);
+        bound_decoding(brkga, brkga_params, control_params, decoder, hooks);
+        brkga.setStoppingCriteria(
+            [&hooks](const BRKGA::AlgorithmStatus& status) -> bool {
+                bool stop = false;
+                for (auto& hook : hooks) {
+                    stop = hook(status) || stop;
+                }
+                return stop;
+            });
 
         auto status = brkga.run(control_params);
-        std::cout << "Ran " << status.current_iteration << " iterations"
-                  << std::endl;
+        decoder.set_cutoff(std::numeric_limits<double>::infinity());
+        if (m_log) {
+            *m_log << "Ran " << status.current_iteration << " iterations"
+                   << std::endl;
+        }
+        if (m_log && m_bounded_decode && Decoder::bounded()) {
+            report_bounded_decode(decoder.stats());
+        }
+        if (cooperative) {
+            cooperative->stop();
+            if (m_log) {
+                *m_log << "Intensification: " << cooperative->jobs()
+                       << " chromosomes searched, "
+                       << cooperative->improvements() << " improved"
+                       << std::endl;
+            }
+        }
+        if (m_log && controller) {
+            *m_log << "Adaptive control: " << controller->adjustments()
+                   << " windows, population size "
+                   << brkga_params.population_size << ", "
+                   << 100 * controller->mutation() << "% extra mutants, "
+                   << "shaking factor " << controller->shaking()
+                   << ", IPR interval " << controller->ipr_interval()
+                   << std::endl;
+        }
 
-        return decoder.rebuild(status.best_chromosome);
+        if (!m_checkpoint_file.empty()) {
+            checkpoint::snapshot(m_instance, brkga, brkga_params)
+                .save(m_checkpoint_file);
+        }
+
+        return decoder.rebuild(
+            best_individual(brkga, brkga_params, status).second);
     }
 
   private:
     using chromosome = BRKGA::Chromosome;
 
-    /*! Decodificador de solução a partir de um cromossomo. */
-    struct next_fit_decoder {
-        instance_t m_instance;
-
-        next_fit_decoder(instance_t instance) : m_instance(instance) {}
-
-        solution_t rebuild(chromosome chromosome) const {
-            // A solução determinada por um cromossomo é uma obtida pela
-            // estratégia "next fit", inserindo os retângulos por ordem
-            // crescente dos valores correspondentes a cada um no cromossomo.
-            std::vector<size_t> permutation =
-                util::sort_permutation(chromosome);
-            return constructive::next_fit(m_instance, permutation);
-        }
-
-        BRKGA::fitness_t decode(chromosome chromosome, bool) const {
-            return m_instance.cost(rebuild(chromosome));
-        }
-    };
-
     /*! Codifica uma solução na forma de cromossomo. */
     chromosome encode(const solution_t& solution) const {
         size_t S = chromosome_size();
@@ -275,49 +995,518 @@ class brkga_mp_ipr {
         return chromosome;
     }
 
-    using algorithm = BRKGA::BRKGA_MP_IPR<next_fit_decoder>;
+    /*! Codifica uma ordem de inserção na forma de cromossomo. */
+    chromosome encode(const order_t& order) const {
+        size_t S = chromosome_size();
+        chromosome chromosome(S);
+        for (size_t i = 0; i < order.size(); i++) {
+            chromosome[order[i]] = i / double(S);
+        }
+        return chromosome;
+    }
+
+    using algorithm = BRKGA::BRKGA_MP_IPR<Decoder>;
+
+    /*! Cromossomo com o seu custo. */
+    using evaluated = std::pair<BRKGA::fitness_t, chromosome>;
+
+    /**
+     * Índices dos `k` piores cromossomos de uma população (no máximo metade
+     * da população), do pior para o melhor. O(k).
+     */
+    static std::vector<unsigned> worst_slots(const algorithm& brkga,
+                                             unsigned population, size_t k) {
+        const auto& ranking = brkga.getCurrentPopulation(population).fitness;
+        size_t N = ranking.size();
+        std::vector<unsigned> slots;
+        for (size_t j = 0; j < std::min(k, N / 2); j++) {
+            slots.push_back(ranking[N - 1 - j].second);
+        }
+        return slots;
+    }
+
+    /**
+     * Injeta cromossomos em uma população com `injectChromosome`, o j-ésimo
+     * no lugar do cromossomo de índice `slots[j]`.
+     *
+     * A biblioteca recebe a posição do cromossomo substituído no ranking, que
+     * muda a cada injeção, já que a população é reordenada. Por isso, os
+     * lugares são escolhidos antes da primeira injeção pelos índices dos
+     * cromossomos, que não mudam, e a posição de cada um é procurada no
+     * ranking logo antes da sua injeção. Cada injeção decodifica o
+     * cromossomo e reordena a população. O(k (N lg N + decodificação)).
+     */
+    static void inject(algorithm& brkga, unsigned population,
+                       const std::vector<unsigned>& slots,
+                       const std::vector<chromosome>& batch) {
+        for (size_t j = 0; j < std::min(slots.size(), batch.size()); j++) {
+            const auto& ranking =
+                brkga.getCurrentPopulation(population).fitness;
+            auto position =
+                std::find_if(ranking.begin(), ranking.end(),
+                             [&](const auto& entry) {
+                                 return entry.second == slots[j];
+                             }) -
+                ranking.begin();
+            brkga.injectChromosome(batch[j], population, unsigned(position));
+        }
+    }
+
+    /**
+     * Melhor cromossomo ao fim da execução. Os cromossomos injetados depois
+     * da última geração não chegam a ser comparados pela biblioteca com o
+     * melhor da execução, então as populações também são consultadas.
+     */
+    static evaluated best_individual(const algorithm& brkga,
+                                     const BRKGA::BrkgaParams& params,
+                                     const BRKGA::AlgorithmStatus& status) {
+        evaluated best = {status.best_fitness, status.best_chromosome};
+        for (unsigned p = 0; p < params.num_independent_populations; p++) {
+            if (brkga.getFitness(p, 0) < best.first) {
+                best = {brkga.getFitness(p, 0), brkga.getChromosome(p, 0)};
+            }
+        }
+        return best;
+    }
+
+    /*! Ação executada ao fim de cada iteração do algoritmo. */
+    using iteration_hook = std::function<bool(const BRKGA::AlgorithmStatus&)>;
+
+    /*! Progresso do algoritmo na última iteração concluída. */
+    struct progress_t {
+        unsigned iteration = 0;
+        double time = 0;
+        double best = std::numeric_limits<double>::infinity();
+    };
 
     /*! Cria a população inicial do algoritmo. */
-    void set_initial_population(algorithm& brkga) const {
-        std::vector<chromosome> population(m_initial.size());
-        std::transform(
-            m_initial.begin(), m_initial.end(), population.begin(),
-            [this](const solution_t& solution) { return encode(solution); });
+    void set_initial_population(algorithm& brkga,
+                                const BRKGA::BrkgaParams& params) const {
+        size_t capacity =
+            size_t(params.population_size) * params.num_independent_populations;
+        std::vector<chromosome> population(
+            m_warm_start.begin(),
+            m_warm_start.begin() + std::min(capacity, m_warm_start.size()));
+        for (size_t i = 0;
+             i < m_initial.size() && population.size() < capacity; i++) {
+            population.push_back(encode(m_initial[i]));
+        }
         brkga.setInitialPopulation(population);
     }
 
+    /*! Configura a gravação periódica de checkpoints. */
+    void save_checkpoints(algorithm& brkga, const BRKGA::BrkgaParams& params,
+                          std::vector<iteration_hook>& hooks) const {
+        if (m_checkpoint_file.empty() || m_checkpoint_interval <= 0) {
+            return;
+        }
+        hooks.push_back(
+            [this, &brkga, &params,
+             last = std::chrono::duration<double>::zero()](
+                const BRKGA::AlgorithmStatus& status) mutable -> bool {
+                if (status.current_time - last >=
+                    std::chrono::duration<double>(m_checkpoint_interval)) {
+                    checkpoint::snapshot(m_instance, brkga, params)
+                        .save(m_checkpoint_file);
+                    last = status.current_time;
+                }
+                return false;
+            });
+    }
+
     /*! Configura a observação de progresso do algoritmo. */
-    void observe_solution_progress(algorithm& brkga) const {
-        int last_update_iteration = -100;
+    void observe_solution_progress(algorithm& brkga,
+                                   progress_t& progress) const {
         brkga.addNewSolutionObserver(
-            [&last_update_iteration](
-                const BRKGA::AlgorithmStatus& status) -> bool {
-                if (status.current_iteration - last_update_iteration >= 100) {
-                    std::cout
+            [this, &progress, last_update_iteration = -100](
+                const BRKGA::AlgorithmStatus& status) mutable -> bool {
+                progress.best = status.best_fitness;
+                if (m_trace) {
+                    m_trace->record({trace::event_kind::improvement,
+                                     status.current_time.count(),
+                                     status.current_iteration,
+                                     status.best_fitness, status.best_fitness,
+                                     0, 0});
+                }
+                if (m_on_improvement) {
+                    m_on_improvement(status);
+                }
+                int since_update =
+                    int(status.current_iteration) - last_update_iteration;
+                if (m_log && since_update >= 100) {
+                    *m_log
                         << "Improved best individual: " << status.best_fitness
                         << ". Iteration " << status.current_iteration
-                        << ". Current time: " << status.current_time
-                        << std::endl;
+                        << ". Current time: " << status.current_time << '\n';
                     last_update_iteration = status.current_iteration;
                 }
                 return true;
             });
     }
 
+    /*! Configura o registro de estatísticas das populações. */
+    void trace_generations(algorithm& brkga, const BRKGA::BrkgaParams& params,
+                           progress_t& progress,
+                           std::vector<iteration_hook>& hooks) const {
+        hooks.push_back([this, &brkga, &params, &progress](
+                            const BRKGA::AlgorithmStatus& status) -> bool {
+            progress.iteration = status.current_iteration;
+            progress.time = status.current_time.count();
+            if (!m_trace) {
+                return false;
+            }
+
+            unsigned P = params.num_independent_populations;
+            unsigned N = params.population_size;
+            unsigned elite = std::max(
+                1u, unsigned(std::ceil(params.elite_percentage * N)));
+            double best = std::numeric_limits<double>::infinity();
+            double threshold = -std::numeric_limits<double>::infinity();
+            double total = 0;
+            for (unsigned p = 0; p < P; p++) {
+                best = std::min(best, brkga.getFitness(p, 0));
+                threshold = std::max(threshold, brkga.getFitness(p, elite - 1));
+                for (unsigned i = 0; i < N; i++) {
+                    total += brkga.getFitness(p, i);
+                }
+            }
+            m_trace->record({trace::event_kind::generation, progress.time,
+                             status.current_iteration, status.best_fitness,
+                             best, total / (double(P) * N), threshold});
+            return false;
+        });
+    }
+
+    /*! Configura a migração de cromossomos entre processos. */
+    void migrate(algorithm& brkga, const BRKGA::BrkgaParams& params,
+                 const BRKGA::ControlParams& control_params,
+                 std::vector<iteration_hook>& hooks) const {
+        if (!m_migration || control_params.exchange_interval == 0) {
+            return;
+        }
+        hooks.push_back([this, &brkga, &params,
+                         interval = control_params.exchange_interval,
+                         last = 0u](const BRKGA::AlgorithmStatus& status) mutable
+                        -> bool {
+            if (status.current_iteration - last < interval) {
+                return false;
+            }
+            last = status.current_iteration;
+
+            // Envia os melhores indivíduos dentre todas as populações.
+            unsigned P = params.num_independent_populations;
+            unsigned k = std::min(params.num_exchange_individuals,
+                                  params.population_size);
+            std::vector<island::migration::individual> elite;
+            for (unsigned p = 0; p < P; p++) {
+                for (unsigned i = 0; i < k; i++) {
+                    elite.push_back(
+                        {brkga.getFitness(p, i), brkga.getChromosome(p, i)});
+                }
+            }
+            std::partial_sort(
+                elite.begin(), elite.begin() + k, elite.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+            elite.resize(k);
+            m_migration->send(elite);
+
+            // Os imigrantes substituem os piores indivíduos de cada
+            // população, limitados à metade de cada população. O custo
+            // enviado pelos pares não é confiável (veja `island::migration`),
+            // então os imigrantes são decodificados na injeção, e os mais
+            // recentes são mantidos quando chegam mais do que cabem.
+            auto immigrants = m_migration->receive();
+            size_t limit = size_t(P) * (params.population_size / 2);
+            if (immigrants.size() > limit) {
+                immigrants.erase(immigrants.begin(),
+                                 immigrants.end() - limit);
+            }
+            std::vector<std::vector<chromosome>> batches(P);
+            for (size_t j = 0; j < immigrants.size(); j++) {
+                batches[j % P].push_back(std::move(immigrants[j]));
+            }
+            for (unsigned p = 0; p < P; p++) {
+                inject(brkga, p, worst_slots(brkga, p, batches[p].size()),
+                       batches[p]);
+            }
+            return false;
+        });
+    }
+
+    /**
+     * Configura a atualização do limite da decodificação limitada.
+     *
+     * O limite só vale para a evolução das populações: os ganchos seguintes
+     * decodificam cromossomos que podem entrar na elite, assim como o
+     * path-relinking e o reinício das populações, então o limite é removido
+     * no começo dos ganchos e restaurado no fim deles. Como a biblioteca
+     * executa o path-relinking e o reinício logo depois da evolução, com o
+     * limite ainda ativo, eles passam a ser executados pelo último gancho,
+     * com os mesmos intervalos.
+     *
+     * Deve ser chamada depois da instalação dos outros ganchos.
+     */
+    void bound_decoding(algorithm& brkga, const BRKGA::BrkgaParams& params,
+                        BRKGA::ControlParams& control_params,
+                        Decoder& decoder,
+                        std::vector<iteration_hook>& hooks) const {
+        if (!m_bounded_decode || !Decoder::bounded()) {
+            return;
+        }
+        hooks.insert(hooks.begin(),
+                     [&decoder](const BRKGA::AlgorithmStatus&) -> bool {
+                         decoder.set_cutoff(
+                             std::numeric_limits<double>::infinity());
+                         return false;
+                     });
+
+        unsigned ipr_interval = control_params.ipr_interval;
+        unsigned reset_interval = control_params.reset_interval;
+        control_params.ipr_interval = 0;
+        control_params.reset_interval = 0;
+        hooks.push_back([&brkga, &params, &decoder, ipr_interval,
+                         reset_interval](
+                            const BRKGA::AlgorithmStatus& status) -> bool {
+            auto due = [&](unsigned interval) {
+                return interval > 0 && status.stalled_iterations > 0 &&
+                       status.stalled_iterations % interval == 0;
+            };
+            if (due(ipr_interval)) {
+                brkga.pathRelink(params.pr_distance_function);
+            }
+            if (due(reset_interval)) {
+                brkga.reset();
+            }
+
+            // Um cromossomo pior que o pior da elite de todas as populações
+            // não entra em nenhuma elite na próxima geração.
+            unsigned elite = std::max(
+                1u, unsigned(std::ceil(params.elite_percentage *
+                                       params.population_size)));
+            double threshold = -std::numeric_limits<double>::infinity();
+            for (unsigned p = 0; p < params.num_independent_populations;
+                 p++) {
+                threshold = std::max(threshold, brkga.getFitness(p, elite - 1));
+            }
+            decoder.set_cutoff(threshold);
+            return false;
+        });
+    }
+
+    /**
+     * Configura a troca de cromossomos com as threads de intensificação ao
+     * fim de cada geração: os cromossomos melhorados substituem os piores
+     * indivíduos das populações, e cada thread ociosa recebe a melhor
+     * solução, caso ela tenha mudado, ou uma elite aleatória.
+     */
+    void cooperate(algorithm& brkga, const BRKGA::BrkgaParams& params,
+                   intensify::cooperative<Decoder>* cooperative,
+                   unsigned seed, std::vector<iteration_hook>& hooks) const {
+        if (!cooperative) {
+            return;
+        }
+        hooks.push_back(
+            [&brkga, &params, cooperative, rng = std::minstd_rand(seed),
+             sent = std::numeric_limits<double>::infinity()](
+                const BRKGA::AlgorithmStatus& status) mutable -> bool {
+                unsigned P = params.num_independent_populations;
+                unsigned N = params.population_size;
+                unsigned elite = std::max(
+                    1u, unsigned(std::ceil(params.elite_percentage * N)));
+
+                // Os lugares dos cromossomos de cada população são escolhidos
+                // antes das injeções (veja `inject`). Quando chegam mais
+                // cromossomos que lugares, entram os melhores.
+                std::vector<std::vector<evaluated>> batches(P);
+                size_t k = 0;
+                cooperative->collect([&](intensify::individual&& individual) {
+                    batches[k++ % P].emplace_back(
+                        individual.fitness, std::move(individual.chromosome));
+                });
+                for (unsigned p = 0; p < P; p++) {
+                    auto slots = worst_slots(brkga, p, batches[p].size());
+                    auto& batch = batches[p];
+                    std::partial_sort(
+                        batch.begin(), batch.begin() + slots.size(),
+                        batch.end(), [](const auto& a, const auto& b) {
+                            return a.first < b.first;
+                        });
+                    std::vector<chromosome> best;
+                    for (size_t j = 0; j < slots.size(); j++) {
+                        best.push_back(std::move(batch[j].second));
+                    }
+                    inject(brkga, p, slots, best);
+                }
+
+                cooperative->set_incumbent(status.best_fitness);
+                std::uniform_int_distribution<unsigned> population(0, P - 1);
+                std::uniform_int_distribution<unsigned> member(0, elite - 1);
+                for (size_t w = 0; w < cooperative->workers(); w++) {
+                    if (!cooperative->idle(w)) {
+                        continue;
+                    }
+                    if (status.best_fitness < sent) {
+                        sent = status.best_fitness;
+                        cooperative->offer(
+                            w, {status.best_chromosome, status.best_fitness});
+                    } else {
+                        unsigned p = population(rng), i = member(rng);
+                        cooperative->offer(w, {brkga.getChromosome(p, i),
+                                               brkga.getFitness(p, i)});
+                    }
+                }
+                return false;
+            });
+    }
+
+    /**
+     * Ajusta o tamanho das populações ao tempo disponível, estimando o tempo
+     * de uma decodificação com alguns cromossomos iniciais, decodificados em
+     * sequência; na execução, as decodificações são divididas entre
+     * `threads` threads. O tamanho fica entre o mínimo exigido pelo
+     * cruzamento e 4 vezes o configurado.
+     */
+    void size_populations(Decoder& decoder, BRKGA::BrkgaParams& params,
+                          double budget, unsigned threads) const {
+        std::minstd_rand rng(0);
+        std::uniform_real_distribution<> uniform(0, 1);
+        size_t samples = 8;
+        util::deadline timer;
+        for (size_t i = 0; i < samples; i++) {
+            chromosome c(chromosome_size());
+            if (i < m_initial.size()) {
+                c = encode(m_initial[i]);
+            } else {
+                std::generate(c.begin(), c.end(),
+                              [&] { return uniform(rng); });
+            }
+            decoder.decode(c, false);
+        }
+        double decode_seconds = timer.elapsed() / samples;
+
+        unsigned minimum = std::max(
+            {10u, params.total_parents,
+             unsigned(std::ceil(params.num_elite_parents /
+                                params.elite_percentage))});
+        params.population_size = adaptive::controller::population_size(
+            budget, decode_seconds, threads,
+            params.num_independent_populations, minimum,
+            4 * params.population_size);
+    }
+
+    /**
+     * Configura o controle adaptativo ao fim de cada geração: atualiza o
+     * controlador, substitui indivíduos aleatórios fora da elite de cada
+     * população pelos mutantes extras e chama o path-relinking quando o
+     * algoritmo está estagnado há pelo menos o intervalo atual.
+     *
+     * O número de mutantes da biblioteca é fixo, então a taxa de mutação só
+     * aumenta em relação à configurada. Os piores indivíduos são quase sempre
+     * os mutantes da própria biblioteca, então os mutantes extras substituem
+     * descendentes: indivíduos sorteados entre as posições [elite, N -
+     * mutantes) do ranking, escolhidos antes das injeções (veja `inject`).
+     */
+    void adapt(algorithm& brkga, const BRKGA::BrkgaParams& params,
+               adaptive::controller* controller, unsigned seed,
+               std::vector<iteration_hook>& hooks) const {
+        if (!controller) {
+            return;
+        }
+        hooks.push_back([this, &brkga, &params, controller,
+                         rng = std::minstd_rand(seed), last_ipr = 0u](
+                            const BRKGA::AlgorithmStatus& status) mutable
+                        -> bool {
+            controller->on_improvement(status.best_fitness);
+            controller->on_generation(status.current_time.count());
+
+            unsigned N = params.population_size;
+            unsigned elite = std::max(
+                1u, unsigned(std::ceil(params.elite_percentage * N)));
+            unsigned mutants =
+                unsigned(std::ceil(params.mutants_percentage * N));
+            unsigned offspring = N - std::min(N, elite + mutants);
+            unsigned extra =
+                std::min(offspring, unsigned(controller->mutation() * N));
+            std::uniform_real_distribution<> uniform(0, 1);
+            std::vector<unsigned> ranks(offspring);
+            std::iota(ranks.begin(), ranks.end(), elite);
+            for (unsigned p = 0; p < params.num_independent_populations; p++) {
+                const auto& ranking = brkga.getCurrentPopulation(p).fitness;
+                std::vector<unsigned> slots;
+                for (unsigned j = 0; j < extra; j++) {
+                    // Sorteio das posições sem repetição (Fisher-Yates).
+                    std::uniform_int_distribution<unsigned> pick(
+                        j, offspring - 1);
+                    std::swap(ranks[j], ranks[pick(rng)]);
+                    slots.push_back(ranking[ranks[j]].second);
+                }
+
+                std::vector<chromosome> batch(extra);
+                for (auto& mutant : batch) {
+                    mutant.resize(chromosome_size());
+                    std::generate(mutant.begin(), mutant.end(),
+                                  [&] { return uniform(rng); });
+                }
+                inject(brkga, p, slots, batch);
+            }
+
+            unsigned interval = controller->ipr_interval();
+            if (interval > 0 && status.stalled_iterations >= interval &&
+                status.current_iteration - last_ipr >= interval) {
+                brkga.pathRelink(params.pr_distance_function);
+                last_ipr = status.current_iteration;
+            }
+            return false;
+        });
+    }
+
+    /*! Escreve as estatísticas da decodificação limitada. */
+    void report_bounded_decode(const decode_stats& stats) const {
+        double total = stats.placed + stats.skipped;
+        *m_log << "Bounded decode: " << stats.aborted << " of "
+               << stats.decodes << " decodes aborted ("
+               << (stats.decodes ? 100.0 * stats.aborted / stats.decodes : 0)
+               << "%), " << (total > 0 ? 100.0 * stats.skipped / total : 0)
+               << "% of placements skipped" << std::endl;
+    }
+
+    /*! Configura a interrupção do algoritmo ao fim do prazo. */
+    void stop_on_deadline(std::vector<iteration_hook>& hooks,
+                          const util::deadline& deadline) const {
+        hooks.push_back([&deadline](const BRKGA::AlgorithmStatus&) -> bool {
+            return deadline.expired();
+        });
+    }
+
     /*! Função de perturbação para as soluções do algoritmo. */
     template <typename URBG>
     decltype(BRKGA::BrkgaParams::custom_shaking)
-    shaking_function(URBG&& rng, next_fit_decoder& decoder) const {
-        return [&](double lower_bound, double upper_bound, auto& populations,
+    shaking_function(URBG&& rng, Decoder& decoder, const progress_t& progress,
+                     const adaptive::controller* controller) const {
+        return [&, controller](double lower_bound, double upper_bound,
+                               auto& populations,
                    auto& shaken) {
             std::uniform_real_distribution<> uniform(0, 1);
 
+            // A perturbação muda também a elite, então os cromossomos
+            // perturbados são reavaliados sem limite.
+            decoder.set_cutoff(std::numeric_limits<double>::infinity());
+
             double chance =
                 std::uniform_real_distribution<>(lower_bound, upper_bound)(rng);
+            if (controller) {
+                chance = std::min(1.0, chance * controller->shaking());
+            }
 
-            std::cout << "Shuffling levels and randomly changing order of "
-                         "rectangles with probability "
-                      << chance << std::endl;
+            if (m_trace) {
+                m_trace->record({trace::event_kind::shake, progress.time,
+                                 progress.iteration, progress.best, 0, 0,
+                                 chance});
+            } else if (m_log) {
+                *m_log << "Shuffling levels and randomly changing order of "
+                          "rectangles with probability "
+                       << chance << '\n';
+            }
 
             for (unsigned i = 0; i < populations.size(); i++) {
                 auto& population = populations[i]->chromosomes;
@@ -349,7 +1538,18 @@ class brkga_mp_ipr {
     }
 
     const instance_t& m_instance;
-    const std::vector<solution_t>& m_initial;
+    std::vector<order_t> m_initial; /// Soluções iniciais
+
+    std::vector<BRKGA::Chromosome> m_warm_start; /// Cromossomos iniciais
+    std::string m_checkpoint_file;               /// Arquivo de checkpoint
+    double m_checkpoint_interval; /// Intervalo entre checkpoints (segundos)
+    bool m_bounded_decode;        /// Decodificação limitada habilitada
+    unsigned m_intensify_workers; /// Threads de intensificação
+    bool m_adaptive;              /// Controle adaptativo habilitado
+    island::migration* m_migration; /// Migração entre processos (opcional)
+    trace::convergence_trace* m_trace; /// Registro de convergência (opcional)
+    observer m_on_improvement;         /// Ação a cada melhoria (opcional)
+    std::ostream* m_log;               /// Saída de progresso (opcional)
 };
 
 } // namespace improvement
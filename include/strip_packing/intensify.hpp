@@ -0,0 +1,349 @@
+#ifndef STRIP_PACKING_INTENSIFY_HPP
+#define STRIP_PACKING_INTENSIFY_HPP
+
+#include "defs.hpp"
+#include "reorder.hpp"
+
+#include "util/level_state.hpp"
+#include "util/spsc_ring.hpp"
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace strip_packing::intensify {
+
+/**
+ * Intensificação de soluções: busca local por realocação de retângulos e
+ * ruína e recriação, sobre o estado incremental `util::level_state`.
+ */
+class local_search {
+  private:
+    const instance_t& m_instance;
+    util::level_state m_state;
+
+    std::vector<std::vector<size_t>> m_levels; /// Retângulos de cada nível
+    std::vector<dim_type> m_used;              /// Largura ocupada por nível
+    std::vector<size_t> m_level;               /// Nível de cada retângulo
+    std::vector<size_t> m_position;            /// Posição no nível
+
+    /*! Remove um retângulo do seu nível. O(log L + log n). */
+    void remove(size_t rect) {
+        size_t level = m_level[rect];
+        auto& items = m_levels[level];
+        size_t last = items.back();
+        items[m_position[rect]] = last;
+        m_position[last] = m_position[rect];
+        items.pop_back();
+        m_used[level] -= m_instance.rects[rect].length;
+        m_state.remove(level, rect);
+    }
+
+    /*! Insere um retângulo em um nível. O(log L + log n). */
+    void insert(size_t level, size_t rect) {
+        if (level == m_levels.size()) {
+            m_state.push_level();
+            m_levels.emplace_back();
+            m_used.push_back(0);
+        }
+        m_level[rect] = level;
+        m_position[rect] = m_levels[level].size();
+        m_levels[level].push_back(rect);
+        m_used[level] += m_instance.rects[rect].length;
+        m_state.insert(level, rect);
+    }
+
+    /**
+     * Nível em que a inserção de um retângulo (já removido) menos aumenta o
+     * custo, dentre os níveis com espaço e um novo nível no topo. O(L log L).
+     */
+    std::pair<size_t, cost_type> best_insertion(size_t rect) const {
+        const auto& r = m_instance.rects[rect];
+        size_t best = m_levels.size();
+        cost_type best_delta = r.weight * m_state.total_height();
+        for (size_t l = 0; l < m_levels.size(); l++) {
+            if (m_used[l] + r.length > m_instance.recipient_length) {
+                continue;
+            }
+            cost_type delta = m_state.insert_delta(l, rect);
+            if (delta < best_delta) {
+                best = l;
+                best_delta = delta;
+            }
+        }
+        return {best, best_delta};
+    }
+
+  public:
+    /*! Constrói o estado correspondente a uma solução. O(n log n). */
+    local_search(const instance_t& instance, const solution_t& solution)
+        : m_instance(instance), m_state(instance),
+          m_level(instance.rects.size()), m_position(instance.rects.size()) {
+        m_state.reserve(solution.size());
+        for (const auto& level : solution) {
+            size_t index = m_levels.size();
+            for (size_t i : level) {
+                insert(index, i);
+            }
+        }
+    }
+
+    /*! Custo da solução atual. O(1). */
+    cost_type cost() const { return m_state.cost(); }
+
+    /**
+     * Busca local por realocação: tenta mover `moves` retângulos aleatórios
+     * para o nível em que eles menos aumentam o custo. Devolve o número de
+     * movimentos que melhoraram a solução. O(moves L log L).
+     */
+    template <typename URBG> size_t relocate(URBG&& rng, size_t moves) {
+        if (m_instance.rects.empty()) {
+            return 0;
+        }
+        std::uniform_int_distribution<size_t> pick(0,
+                                                   m_instance.rects.size() - 1);
+        size_t improved = 0;
+        for (size_t k = 0; k < moves; k++) {
+            size_t rect = pick(rng);
+            size_t from = m_level[rect];
+            remove(rect);
+
+            // O nível original é sempre uma opção, e só é trocado por outro
+            // estritamente melhor.
+            cost_type stay = m_state.insert_delta(from, rect);
+            auto [to, delta] = best_insertion(rect);
+            if (delta < stay) {
+                insert(to, rect);
+                improved++;
+            } else {
+                insert(from, rect);
+            }
+        }
+        return improved;
+    }
+
+    /**
+     * Ruína e recriação: remove uma fração dos retângulos, escolhidos
+     * aleatoriamente, e os reinsere em ordem decrescente de densidade, cada
+     * um no nível em que ele menos aumenta o custo. O(k L log L) para k
+     * retângulos removidos. A mudança não é desfeita, mesmo que piore o custo.
+     */
+    template <typename URBG>
+    void ruin_and_recreate(URBG&& rng, double fraction) {
+        size_t n = m_instance.rects.size();
+        size_t k = std::clamp<size_t>(size_t(fraction * n), 1, n);
+
+        std::vector<size_t> removed(n);
+        std::iota(removed.begin(), removed.end(), 0);
+        for (size_t i = 0; i < k; i++) {
+            std::uniform_int_distribution<size_t> pick(i, n - 1);
+            std::swap(removed[i], removed[pick(rng)]);
+        }
+        removed.resize(k);
+
+        for (size_t rect : removed) {
+            remove(rect);
+        }
+        std::sort(removed.begin(), removed.end(), [&](size_t a, size_t b) {
+            const auto& ra = m_instance.rects[a];
+            const auto& rb = m_instance.rects[b];
+            return ra.weight * rb.area() > rb.weight * ra.area();
+        });
+        for (size_t rect : removed) {
+            insert(best_insertion(rect).first, rect);
+        }
+    }
+
+    /*! Solução atual, sem níveis vazios e reordenada de forma ótima. */
+    solution_t solution() const {
+        solution_t solution;
+        for (const auto& level : m_levels) {
+            if (!level.empty()) {
+                solution.push_back(level);
+            }
+        }
+        return reorder::smith(m_instance, std::move(solution));
+    }
+};
+
+/**
+ * Intensifica uma solução, alternando a busca local por realocação com
+ * rodadas de ruína e recriação (aceitas apenas se melhorarem a solução),
+ * e devolve a melhor solução encontrada.
+ */
+template <typename URBG>
+solution_t improve(const instance_t& instance, const solution_t& solution,
+                   URBG&& rng, unsigned rounds, double ruin_fraction = 0.1) {
+    size_t moves = instance.rects.size();
+
+    auto best = std::make_unique<local_search>(instance, solution);
+    best->relocate(rng, moves);
+    for (unsigned r = 0; r < rounds; r++) {
+        auto candidate = std::make_unique<local_search>(*best);
+        candidate->ruin_and_recreate(rng, ruin_fraction);
+        candidate->relocate(rng, moves);
+        if (candidate->cost() < best->cost()) {
+            best = std::move(candidate);
+        }
+    }
+    return best->solution();
+}
+
+/*! Cromossomo trocado entre o BRKGA e as threads de intensificação. */
+struct individual {
+    BRKGA::Chromosome chromosome;
+    double fitness;
+};
+
+/**
+ * Threads de intensificação que cooperam com o BRKGA durante a execução.
+ *
+ * Cada thread recebe cromossomos (a melhor solução ou elites aleatórias) por
+ * uma fila sem travas de entrada, decodifica, intensifica com `improve` e,
+ * caso o cromossomo da solução melhorada seja melhor que o original, devolve
+ * ele por uma fila sem travas de saída. Cada fila tem um único produtor e um
+ * único consumidor: a thread principal do algoritmo, que distribui e coleta
+ * os cromossomos entre gerações, e a thread de intensificação.
+ *
+ * O custo da melhor solução conhecida também é compartilhado sem travas, e
+ * as threads descartam cromossomos piores que ela por uma margem grande
+ * antes de intensificá-los.
+ *
+ * @param Decoder - decodificador de cromossomos do BRKGA.
+ */
+template <typename Decoder> class cooperative {
+  public:
+    /*! Codificação de uma solução na forma de cromossomo. */
+    using encoder = std::function<BRKGA::Chromosome(const solution_t&)>;
+
+    cooperative(const instance_t& instance, const Decoder& decoder,
+                encoder encode, unsigned workers, unsigned seed,
+                unsigned rounds = 10)
+        : m_instance(instance), m_decoder(decoder),
+          m_encode(std::move(encode)), m_rounds(rounds), m_stop(false),
+          m_incumbent(std::numeric_limits<double>::infinity()), m_jobs(0),
+          m_improvements(0) {
+        for (unsigned w = 0; w < workers; w++) {
+            m_inputs.push_back(
+                std::make_unique<util::spsc_ring<individual>>(1));
+            m_outputs.push_back(
+                std::make_unique<util::spsc_ring<individual>>(4));
+        }
+        for (unsigned w = 0; w < workers; w++) {
+            m_threads.emplace_back(&cooperative::work, this, w, seed + w);
+        }
+    }
+
+    ~cooperative() { stop(); }
+
+    cooperative(const cooperative&) = delete;
+    cooperative& operator=(const cooperative&) = delete;
+
+    /*! Número de threads. */
+    size_t workers() const { return m_threads.size(); }
+
+    /*! Se uma thread não tem nenhum cromossomo esperando na entrada. */
+    bool idle(size_t worker) const { return m_inputs[worker]->empty(); }
+
+    /*! Entrega um cromossomo a uma thread, caso haja espaço. */
+    bool offer(size_t worker, individual s) {
+        return m_inputs[worker]->try_push(std::move(s));
+    }
+
+    /*! Atualiza o custo da melhor solução conhecida. */
+    void set_incumbent(double fitness) {
+        m_incumbent.store(fitness, std::memory_order_relaxed);
+    }
+
+    /*! Chama `f(individual&&)` para cada cromossomo melhorado pelas threads. */
+    template <typename F> size_t collect(F&& f) {
+        size_t count = 0;
+        individual s;
+        for (auto& output : m_outputs) {
+            while (output->try_pop(s)) {
+                f(std::move(s));
+                count++;
+            }
+        }
+        return count;
+    }
+
+    /*! Interrompe as threads e espera elas terminarem. */
+    void stop() {
+        m_stop = true;
+        for (auto& thread : m_threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    /*! Número de cromossomos intensificados. */
+    uint64_t jobs() const { return m_jobs; }
+
+    /*! Número de cromossomos melhorados pela intensificação. */
+    uint64_t improvements() const { return m_improvements; }
+
+  private:
+    const instance_t& m_instance;
+    const Decoder& m_decoder;
+    encoder m_encode;
+    unsigned m_rounds;
+
+    std::vector<std::unique_ptr<util::spsc_ring<individual>>> m_inputs;
+    std::vector<std::unique_ptr<util::spsc_ring<individual>>> m_outputs;
+    std::vector<std::thread> m_threads;
+
+    std::atomic<bool> m_stop;
+    std::atomic<double> m_incumbent;
+    std::atomic<uint64_t> m_jobs, m_improvements;
+
+    void work(size_t worker, unsigned seed) {
+        using namespace std::chrono_literals;
+        std::minstd_rand rng(seed);
+        individual s;
+        while (!m_stop) {
+            if (!m_inputs[worker]->try_pop(s)) {
+                std::this_thread::sleep_for(1ms);
+                continue;
+            }
+
+            // Elites muito piores que a melhor solução dificilmente a
+            // superam, e a mesma thread pode receber algo melhor logo.
+            double incumbent = m_incumbent.load(std::memory_order_relaxed);
+            if (s.fitness > 1.5 * incumbent) {
+                continue;
+            }
+
+            solution_t solution =
+                improve(m_instance, m_decoder.rebuild(s.chromosome), rng,
+                        m_rounds);
+            m_jobs++;
+
+            // A solução melhorada só é útil se o decodificador a reproduz
+            // (ou algo melhor) a partir do cromossomo.
+            BRKGA::Chromosome chromosome = m_encode(solution);
+            double fitness = m_instance.cost(m_decoder.rebuild(chromosome));
+            if (fitness < s.fitness) {
+                m_improvements++;
+                m_outputs[worker]->try_push({std::move(chromosome), fitness});
+            }
+        }
+    }
+};
+
+} // namespace strip_packing::intensify
+
+#endif // STRIP_PACKING_INTENSIFY_HPP
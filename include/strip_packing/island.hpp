@@ -0,0 +1,289 @@
+#ifndef STRIP_PACKING_ISLAND_HPP
+#define STRIP_PACKING_ISLAND_HPP
+
+#include "util/socket.hpp"
+#include "util/sort.hpp"
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace strip_packing::island {
+
+/**
+ * Migração de cromossomos de elite entre processos (modelo de ilhas
+ * distribuído).
+ *
+ * Cada processo escuta conexões em um endpoint e se conecta aos endpoints
+ * dos seus pares. Os cromossomos enviados chegam a todos os pares, e os
+ * recebidos ficam em uma caixa de entrada até serem consumidos pelo
+ * algoritmo. Toda a comunicação é feita por threads auxiliares, de forma que
+ * o algoritmo nunca bloqueia esperando a rede.
+ *
+ * Cada mensagem é prefixada pelo seu tamanho, e tem o formato binário (na
+ * ordem de bytes nativa):
+ *
+ *     "SPIM" | n (u32) | k (u32) | k x (fitness (f64), n x posição (u32))
+ *
+ * Assim como nos checkpoints, cada cromossomo é enviado como o vetor de
+ * posições de cada gene na ordenação das chaves. Mensagens cujos vetores não
+ * são permutações são descartadas.
+ *
+ * O custo enviado é ignorado pelo receptor: os pares podem usar outro
+ * decodificador, outra instância com o mesmo número de retângulos, ou nem
+ * ser processos confiáveis, então os imigrantes são decodificados
+ * localmente quando entram nas populações.
+ */
+class migration {
+  public:
+    using individual = std::pair<BRKGA::fitness_t, BRKGA::Chromosome>;
+
+  private:
+    static constexpr char MAGIC[4] = {'S', 'P', 'I', 'M'};
+
+    /*! Espera máxima (segundos) por uma conexão a um par. */
+    static constexpr double CONNECT_TIMEOUT = 1;
+
+    /*! Conexão de saída para um par. */
+    struct peer {
+        util::endpoint address;
+        util::socket_fd fd;
+    };
+
+    size_t m_chromosome_size;
+
+    util::socket_fd m_listener;
+    std::vector<peer> m_peers;
+
+    std::mutex m_inbox_mutex;
+    std::vector<BRKGA::Chromosome> m_inbox;
+
+    std::mutex m_outbox_mutex;
+    std::condition_variable m_outbox_cv;
+    std::deque<std::vector<char>> m_outbox;
+
+    std::mutex m_readers_mutex;
+    std::vector<std::shared_ptr<util::socket_fd>> m_readers_fds;
+    std::vector<std::thread> m_readers;
+
+    std::atomic<bool> m_stop;
+    std::atomic<uint64_t> m_sent;
+    std::atomic<uint64_t> m_received;
+
+    std::thread m_acceptor;
+    std::thread m_sender;
+
+    std::vector<char> serialize(const std::vector<individual>& elite) const {
+        size_t n = m_chromosome_size;
+        std::vector<char> payload(sizeof(MAGIC) + 2 * sizeof(uint32_t) +
+                                  elite.size() *
+                                      (sizeof(double) + n * sizeof(uint32_t)));
+        char* p = payload.data();
+        auto put = [&p](const void* data, size_t size) {
+            std::memcpy(p, data, size);
+            p += size;
+        };
+
+        uint32_t header[2] = {uint32_t(n), uint32_t(elite.size())};
+        put(MAGIC, sizeof(MAGIC));
+        put(header, sizeof(header));
+
+        std::vector<uint32_t> rank(n);
+        for (const auto& [fitness, chromosome] : elite) {
+            std::vector<size_t> permutation =
+                util::sort_permutation(chromosome);
+            for (size_t i = 0; i < n; i++) {
+                rank[permutation[i]] = i;
+            }
+            double f = fitness;
+            put(&f, sizeof(f));
+            put(rank.data(), n * sizeof(uint32_t));
+        }
+        return payload;
+    }
+
+    /*! Decodifica uma mensagem. Mensagens malformadas são descartadas. */
+    void deserialize(const std::vector<char>& payload) {
+        size_t n = m_chromosome_size;
+        uint32_t header[2];
+        if (payload.size() < sizeof(MAGIC) + sizeof(header) ||
+            std::memcmp(payload.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            return;
+        }
+        const char* p = payload.data() + sizeof(MAGIC);
+        std::memcpy(header, p, sizeof(header));
+        p += sizeof(header);
+
+        size_t record = sizeof(double) + n * sizeof(uint32_t);
+        if (header[0] != n ||
+            payload.size() != sizeof(MAGIC) + sizeof(header) +
+                                  header[1] * record) {
+            return;
+        }
+
+        std::vector<BRKGA::Chromosome> received(header[1]);
+        std::vector<uint32_t> rank(n);
+        std::vector<bool> seen(n);
+        for (auto& chromosome : received) {
+            std::memcpy(rank.data(), p + sizeof(double), n * sizeof(uint32_t));
+            p += record;
+
+            std::fill(seen.begin(), seen.end(), false);
+            for (uint32_t r : rank) {
+                if (r >= n || seen[r]) {
+                    return;
+                }
+                seen[r] = true;
+            }
+
+            chromosome.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                chromosome[i] = (rank[i] + 0.5) / n;
+            }
+        }
+
+        m_received += received.size();
+        std::lock_guard<std::mutex> lock(m_inbox_mutex);
+        for (auto& chromosome : received) {
+            m_inbox.push_back(std::move(chromosome));
+        }
+    }
+
+    /*! Aceita conexões de pares, criando uma thread de leitura para cada. */
+    void accept_loop() {
+        util::socket_fd fd;
+        while (!m_stop && util::accept_from(m_listener.get(), fd)) {
+            if (!fd.valid()) {
+                continue;
+            }
+            auto conn = std::make_shared<util::socket_fd>(std::move(fd));
+            std::lock_guard<std::mutex> lock(m_readers_mutex);
+            if (m_stop) {
+                break;
+            }
+            m_readers_fds.push_back(conn);
+            m_readers.emplace_back([this, conn] {
+                std::vector<char> payload;
+                while (!m_stop && util::recv_frame(conn->get(), payload)) {
+                    deserialize(payload);
+                }
+            });
+        }
+    }
+
+    /*! Envia as mensagens pendentes a todos os pares. */
+    void send_loop() {
+        while (true) {
+            std::vector<char> payload;
+            {
+                std::unique_lock<std::mutex> lock(m_outbox_mutex);
+                m_outbox_cv.wait(lock,
+                                 [this] { return m_stop || !m_outbox.empty(); });
+                if (m_stop) {
+                    return;
+                }
+                payload = std::move(m_outbox.front());
+                m_outbox.pop_front();
+            }
+
+            // Pares que ainda não subiram (ou que caíram) são reconectados
+            // no próximo envio. A espera pela conexão é limitada para que um
+            // par inalcançável não atrase os demais nem o encerramento.
+            for (auto& p : m_peers) {
+                if (!p.fd.valid()) {
+                    p.fd = util::connect_to(p.address, CONNECT_TIMEOUT);
+                }
+                if (p.fd.valid() && !util::send_frame(p.fd.get(), payload)) {
+                    p.fd.close();
+                }
+            }
+        }
+    }
+
+  public:
+    /**
+     * Cria o canal de migração, escutando em um endpoint e enviando
+     * cromossomos para uma lista de pares.
+     */
+    migration(const std::string& listen, const std::vector<std::string>& peers,
+              size_t chromosome_size)
+        : m_chromosome_size(chromosome_size),
+          m_listener(util::listen_on(util::endpoint::parse(listen))),
+          m_stop(false), m_sent(0), m_received(0) {
+        for (const auto& address : peers) {
+            m_peers.push_back(
+                {util::endpoint::parse(address), util::socket_fd()});
+        }
+        m_acceptor = std::thread([this] { accept_loop(); });
+        m_sender = std::thread([this] { send_loop(); });
+    }
+
+    migration(const migration&) = delete;
+    migration& operator=(const migration&) = delete;
+
+    ~migration() {
+        m_stop = true;
+        m_outbox_cv.notify_all();
+
+        // Desbloqueia as chamadas bloqueantes de accept e recv.
+        ::shutdown(m_listener.get(), SHUT_RDWR);
+        m_acceptor.join();
+        m_sender.join();
+        {
+            std::lock_guard<std::mutex> lock(m_readers_mutex);
+            for (auto& fd : m_readers_fds) {
+                ::shutdown(fd->get(), SHUT_RDWR);
+            }
+        }
+        for (auto& reader : m_readers) {
+            reader.join();
+        }
+    }
+
+    /*! Envia cromossomos a todos os pares, de forma assíncrona. */
+    void send(const std::vector<individual>& elite) {
+        if (elite.empty() || m_peers.empty()) {
+            return;
+        }
+        auto payload = serialize(elite);
+        {
+            std::lock_guard<std::mutex> lock(m_outbox_mutex);
+            m_outbox.push_back(std::move(payload));
+        }
+        m_sent += elite.size();
+        m_outbox_cv.notify_one();
+    }
+
+    /**
+     * Consome os cromossomos recebidos desde a última chamada, na ordem de
+     * chegada.
+     */
+    std::vector<BRKGA::Chromosome> receive() {
+        std::vector<BRKGA::Chromosome> received;
+        std::lock_guard<std::mutex> lock(m_inbox_mutex);
+        received.swap(m_inbox);
+        return received;
+    }
+
+    /*! Número de cromossomos enviados. */
+    uint64_t sent() const { return m_sent; }
+
+    /*! Número de cromossomos recebidos. */
+    uint64_t received() const { return m_received; }
+};
+
+} // namespace strip_packing::island
+
+#endif // STRIP_PACKING_ISLAND_HPP
@@ -0,0 +1,334 @@
+#ifndef STRIP_PACKING_ONLINE_HPP
+#define STRIP_PACKING_ONLINE_HPP
+
+#include "defs.hpp"
+#include "heuristics.hpp"
+#include "pipeline.hpp"
+
+#include "util/first_fit.hpp"
+#include "util/level_state.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace strip_packing::online {
+
+/**
+ * Empacotamento online de retângulos que chegam continuamente.
+ *
+ * Cada retângulo é inserido assim que chega, com first-fit sobre o espaço
+ * livre dos níveis atuais (`util::first_fit_tree`), e o custo da solução é
+ * mantido incrementalmente (`util::level_state`). Assim, cada inserção custa
+ * O(log L), onde L é o número de níveis.
+ *
+ * Opcionalmente, uma thread de fundo reotimiza periodicamente uma janela com
+ * os níveis mais recentes: os retângulos dela são reempacotados pelas
+ * heurísticas construtivas aleatorizadas, e a janela é substituída caso o
+ * custo local diminua sem aumentar a altura total da janela (de forma que os
+ * níveis acima dela não sobem). A reotimização trabalha sobre uma cópia da
+ * janela, sem bloquear as inserções, e só é aplicada se nenhum nível da
+ * janela foi modificado enquanto isso (cada nível guarda a versão da sua
+ * última modificação).
+ *
+ * Como a reotimização pode mover retângulos de nível, o nível devolvido pela
+ * inserção é o nível no momento da inserção; a solução atual é obtida por
+ * `solution()`.
+ */
+class packer {
+  private:
+    instance_t m_instance;                   /// Retângulos recebidos
+    std::vector<std::vector<size_t>> m_levels; /// Retângulos por nível
+    util::first_fit_tree<dim_type> m_free;   /// Espaço livre dos níveis
+    util::level_state m_state;               /// Alturas, pesos e custo
+    std::vector<uint64_t> m_stamp;           /// Última modificação do nível
+    uint64_t m_version;                      /// Versão atual
+
+    mutable std::mutex m_mutex;
+
+    std::thread m_worker;
+    std::condition_variable m_worker_cv;
+    bool m_stop;
+
+    std::atomic<uint64_t> m_reoptimizations; /// Reotimizações executadas
+    std::atomic<uint64_t> m_improvements;    /// Reotimizações aplicadas
+
+    /*! Cópia de uma janela de níveis. */
+    struct window_t {
+        size_t first;          /// Primeiro nível da janela
+        uint64_t version;      /// Versão no momento da cópia
+        instance_t instance;   /// Retângulos da janela, reindexados
+        std::vector<size_t> ids; /// Índice original de cada retângulo
+        solution_t solution;   /// Níveis atuais da janela (reindexados)
+    };
+
+    /*! Altura total de uma solução. O(n). */
+    static dim_type total_height(const instance_t& instance,
+                                 const solution_t& solution) {
+        dim_type total = 0;
+        for (const auto& level : solution) {
+            dim_type height = 0;
+            for (size_t i : level) {
+                height = std::max(height, instance.rects[i].height);
+            }
+            total += height;
+        }
+        return total;
+    }
+
+    /*! Copia os últimos `size` níveis. Deve ser chamada com o mutex travado. */
+    window_t copy_window(size_t size) const {
+        window_t window;
+        window.first = m_levels.size() - std::min(size, m_levels.size());
+        window.version = m_version;
+        window.instance.recipient_length = m_instance.recipient_length;
+        for (size_t l = window.first; l < m_levels.size(); l++) {
+            window.solution.emplace_back();
+            for (size_t id : m_levels[l]) {
+                window.solution.back().push_back(window.ids.size());
+                window.ids.push_back(id);
+                window.instance.rects.push_back(m_instance.rects[id]);
+            }
+        }
+        return window;
+    }
+
+    /*! Define o conteúdo de um nível. Deve ser chamada com o mutex travado. */
+    void assign_level(size_t level, const std::vector<size_t>& rects) {
+        for (size_t id : m_levels[level]) {
+            m_state.remove(level, id);
+        }
+        m_levels[level] = rects;
+
+        dim_type free = m_instance.recipient_length;
+        for (size_t id : rects) {
+            m_state.insert(level, id);
+            free -= m_instance.rects[id].length;
+        }
+        // A diminuição pode ser negativa (o espaço livre aumenta).
+        m_free.decrease(level, m_free[level] - free);
+        m_stamp[level] = m_version;
+    }
+
+    /*! Adiciona um nível vazio. Deve ser chamada com o mutex travado. */
+    size_t push_level() {
+        m_levels.emplace_back();
+        m_free.push_back(m_instance.recipient_length);
+        m_stamp.push_back(m_version);
+        return m_state.push_level();
+    }
+
+  public:
+    /*! Resultado de uma inserção. */
+    struct placement {
+        size_t rect;  /// Índice do retângulo
+        size_t level; /// Nível em que ele foi inserido
+    };
+
+    packer(dim_type recipient_length)
+        : m_state(m_instance), m_version(0), m_stop(false),
+          m_reoptimizations(0), m_improvements(0) {
+        m_instance.recipient_length = recipient_length;
+    }
+
+    packer(const packer&) = delete;
+    packer& operator=(const packer&) = delete;
+
+    ~packer() { stop(); }
+
+    /**
+     * Insere um retângulo no nível mais baixo com espaço para ele, ou em um
+     * novo nível. O(log L) amortizado.
+     */
+    placement insert(const rect_t& rect) {
+        if (!(rect.length > 0) ||
+            rect.length > m_instance.recipient_length) {
+            throw std::invalid_argument("rectangle does not fit the strip");
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t id = m_instance.rects.size();
+        m_instance.rects.push_back(rect);
+
+        size_t level = m_free.first_fit(rect.length);
+        if (level == decltype(m_free)::npos) {
+            level = push_level();
+        }
+        m_free.decrease(level, rect.length);
+        m_levels[level].push_back(id);
+        m_state.insert(level, id);
+        m_stamp[level] = ++m_version;
+        return {id, level};
+    }
+
+    /*! Custo da solução atual. O(1). */
+    cost_type cost() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_state.cost();
+    }
+
+    /*! Número de retângulos recebidos. */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_instance.rects.size();
+    }
+
+    /*! Número de níveis (incluindo níveis esvaziados pela reotimização). */
+    size_t levels() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_levels.size();
+    }
+
+    /*! Cópia da instância formada pelos retângulos recebidos. O(n). */
+    instance_t instance() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_instance;
+    }
+
+    /*! Cópia da solução atual, sem níveis vazios. O(n). */
+    solution_t solution() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        solution_t solution;
+        for (const auto& level : m_levels) {
+            if (!level.empty()) {
+                solution.push_back(level);
+            }
+        }
+        return solution;
+    }
+
+    /*! Número de reotimizações executadas e aplicadas. */
+    uint64_t reoptimizations() const { return m_reoptimizations; }
+    uint64_t improvements() const { return m_improvements; }
+
+    /**
+     * Reotimiza os últimos `window` níveis, com `samples` amostras de cada
+     * heurística construtiva aleatorizada. Devolve se a janela foi
+     * substituída.
+     */
+    template <typename URBG>
+    bool reoptimize(size_t window, size_t samples, URBG&& rng) {
+        window_t copy;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            copy = copy_window(window);
+        }
+        m_reoptimizations++;
+        if (copy.instance.rects.empty()) {
+            return false;
+        }
+
+        // Reempacota a janela fora da seção crítica.
+        using namespace heuristics::constructive;
+        const instance_t& sub = copy.instance;
+        cost_type current = sub.cost(copy.solution);
+        dim_type height = total_height(sub, copy.solution);
+
+        std::normal_distribution<> weight_noise(
+            0.0, .25 * pipeline::stddev(
+                           sub, [](const rect_t& r) { return r.weight; }));
+        std::normal_distribution<> height_noise(
+            0.0, .25 * pipeline::stddev(
+                           sub, [](const rect_t& r) { return r.height; }));
+
+        solution_t best;
+        cost_type best_cost = current;
+        auto consider = [&](solution_t&& solution) {
+            cost_type cost = sub.cost(solution);
+            if (cost < best_cost && total_height(sub, solution) <= height) {
+                best = std::move(solution);
+                best_cost = cost;
+            }
+        };
+        for (size_t i = 0; i < samples; i++) {
+            consider(randomized_first_fit_decreasing_density(sub, rng,
+                                                             weight_noise));
+            consider(randomized_best_fit_increasing_height(sub, rng,
+                                                           height_noise));
+        }
+        if (best.empty()) {
+            return false;
+        }
+
+        // Aplica a nova janela, caso ela não tenha sido modificada.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t last = copy.first + copy.solution.size();
+        for (size_t l = copy.first; l < last; l++) {
+            if (m_stamp[l] > copy.version) {
+                return false;
+            }
+        }
+        best.erase(std::remove_if(best.begin(), best.end(),
+                                  [](const auto& level) {
+                                      return level.empty();
+                                  }),
+                   best.end());
+        if (best.size() > copy.solution.size() && last != m_levels.size()) {
+            // Não há como abrir níveis no meio da pilha.
+            return false;
+        }
+
+        ++m_version;
+        for (size_t i = 0; i < std::max(best.size(), copy.solution.size());
+             i++) {
+            std::vector<size_t> rects;
+            if (i < best.size()) {
+                for (size_t j : best[i]) {
+                    rects.push_back(copy.ids[j]);
+                }
+            }
+            size_t level = copy.first + i;
+            if (level == m_levels.size()) {
+                push_level();
+            }
+            assign_level(level, rects);
+        }
+        m_improvements++;
+        return true;
+    }
+
+    /**
+     * Inicia a reotimização periódica em uma thread de fundo, a cada
+     * intervalo dado.
+     */
+    void start(std::chrono::milliseconds interval, size_t window,
+               size_t samples, unsigned seed = 0) {
+        stop();
+        m_stop = false;
+        m_worker = std::thread([this, interval, window, samples, seed] {
+            std::minstd_rand rng(seed);
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_worker_cv.wait_for(lock, interval,
+                                         [this] { return m_stop; })) {
+                lock.unlock();
+                reoptimize(window, samples, rng);
+                lock.lock();
+            }
+        });
+    }
+
+    /*! Interrompe a reotimização periódica. */
+    void stop() {
+        if (!m_worker.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_worker_cv.notify_all();
+        m_worker.join();
+    }
+};
+
+} // namespace strip_packing::online
+
+#endif // STRIP_PACKING_ONLINE_HPP
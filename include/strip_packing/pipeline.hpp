@@ -0,0 +1,460 @@
+#ifndef STRIP_PACKING_PIPELINE_HPP
+#define STRIP_PACKING_PIPELINE_HPP
+
+#include "compress.hpp"
+#include "defs.hpp"
+#include "heuristics.hpp"
+#include "pool.hpp"
+#include "portfolio.hpp"
+#include "reorder.hpp"
+
+#include "util/deadline.hpp"
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace strip_packing::pipeline {
+
+/*! Opções do pipeline de solução. */
+struct options {
+    size_t first_fit_samples = 500;     /// Amostras de first-fit
+    double first_fit_deviations = .25;  /// Ruído do first-fit (desvios)
+    size_t best_fit_samples = 500;      /// Amostras de best-fit
+    double best_fit_deviations = .25;   /// Ruído do best-fit (desvios)
+    std::vector<std::string> heuristics; /// Heurísticas construtivas extras
+    size_t heuristic_samples = 500;     /// Amostras de cada heurística extra
+    double heuristic_deviations = .25;  /// Ruído das heurísticas extras
+    bool portfolio = false;             /// Portfólio adaptativo
+    bool compress = false;              /// Amostras na instância comprimida
+    unsigned threads = 1;               /// Threads do portfólio
+    size_t pool_size = 1000;            /// Soluções iniciais do BRKGA
+    bool brkga = true;                  /// Se o BRKGA deve ser executado
+    std::string decoder = "next-fit";   /// Decodificador do BRKGA
+    bool bounded_decode = false;        /// Decodificação limitada
+    bool reorder_levels = true;         /// Reordenação ótima dos níveis
+    unsigned intensify = 0;             /// Threads de intensificação
+    bool adaptive = false;              /// Controle adaptativo do BRKGA
+    unsigned brkga_threads = 1;         /// Threads de decodificação
+    double constructive_fraction = 0.2; /// Fração do prazo das construtivas
+};
+
+/*! Progresso da solução. */
+struct progress {
+    double time;        /// Tempo desde o início (em segundos)
+    unsigned iteration; /// Iteração do BRKGA (0 nas heurísticas construtivas)
+    cost_type best;     /// Custo da melhor solução
+};
+
+/*! Ação executada a cada nova melhor solução. */
+using progress_callback = std::function<void(const progress&)>;
+
+/*! Desvio padrão de um atributo dos retângulos de uma instância. O(n). */
+template <typename F>
+inline double stddev(const instance_t& instance, F&& attribute) {
+    double n = instance.rects.size(), mean = 0, acc = 0;
+    for (const auto& rect : instance.rects) {
+        mean += attribute(rect) / n;
+    }
+    for (const auto& rect : instance.rects) {
+        acc += std::pow(attribute(rect) - mean, 2);
+    }
+    return std::sqrt(acc / n);
+}
+
+/*! Melhores soluções das heurísticas construtivas principais. */
+struct constructive_result {
+    solution_t first_fit; /// Melhor first-fit (vazia se não houver)
+    solution_t best_fit;  /// Melhor best-fit (vazia se não houver)
+};
+
+/**
+ * Fases de solução de uma instância: as heurísticas construtivas
+ * aleatorizadas, que preenchem o conjunto de soluções iniciais, seguidas do
+ * BRKGA inicializado com ele.
+ *
+ * É usado pelo executável de heurísticas, que acrescenta a escrita de
+ * arquivos e os recursos de execuções longas (checkpoints, registros e
+ * ilhas) por `improve`, e pelo serviço e pelo ajuste de parâmetros, por meio
+ * de `solve`.
+ *
+ * A melhor solução dentre todas as fases é mantida, e cada nova melhor
+ * solução, inclusive as amostras das heurísticas construtivas, é reportada
+ * à ação de progresso.
+ */
+class solver {
+  private:
+    const instance_t& m_instance;
+    options m_options;
+    std::ostream* m_log;
+    progress_callback m_on_progress;
+    util::deadline m_clock; /// Tempo desde o início
+
+    double m_weight_stddev;
+    double m_height_stddev;
+
+    /*! Instância comprimida (caso a compressão esteja habilitada). */
+    std::optional<compress::compressed_instance> m_compressed;
+
+    pool::solution_pool m_initial; /// Soluções iniciais do BRKGA
+
+    solution_t m_best;      /// Melhor solução dentre todas as fases
+    cost_type m_best_cost; /// Custo da melhor solução (-1 se não houver)
+    cost_type m_reported;  /// Último custo reportado (-1 se nenhum)
+
+    /*! Reporta um custo, caso seja melhor que todos os anteriores. */
+    void report(unsigned iteration, cost_type cost) {
+        if (m_reported < 0 || cost < m_reported) {
+            m_reported = cost;
+            if (m_on_progress) {
+                m_on_progress({m_clock.elapsed(), iteration, cost});
+            }
+        }
+    }
+
+    /*! Gera amostras sobre a instância comprimida (veja `samples`). */
+    template <class CompressedSample>
+    solution_t compressed_samples(size_t samples,
+                                  const util::deadline& deadline,
+                                  CompressedSample&& compressed_sample) {
+        compress::compressed_solution best;
+        cost_type best_cost = -1;
+        for (size_t i = 0; i < samples && (i == 0 || !deadline.expired());
+             i++) {
+            auto solution = compressed_sample();
+            if (m_options.reorder_levels) {
+                solution = compress::smith(*m_compressed, std::move(solution));
+            }
+            cost_type cost = m_compressed->cost(solution);
+            report(0, cost);
+            m_initial.offer(cost, [&] {
+                return compress::expand(*m_compressed, solution);
+            });
+            if (best_cost < 0 || cost < best_cost) {
+                best = std::move(solution);
+                best_cost = cost;
+            }
+        }
+        return compress::expand(*m_compressed, best);
+    }
+
+    /**
+     * Gera amostras de uma heurística construtiva aleatorizada, oferecendo-as
+     * ao conjunto de soluções iniciais.
+     *
+     * Com a instância comprimida, as amostras são geradas sobre as classes de
+     * retângulos, e só são expandidas quando entram no conjunto (e, para a
+     * melhor delas, ao fim). Heurísticas sem versão sobre classes passam
+     * `nullptr` no lugar de `compressed_sample`.
+     *
+     * Devolve a melhor solução dentre todas as soluções geradas. A geração
+     * de amostras é interrompida quando o prazo expira, mas pelo menos uma
+     * amostra é sempre gerada.
+     */
+    template <class Sample, class CompressedSample>
+    solution_t samples(size_t samples, const util::deadline& deadline,
+                       Sample&& sample, CompressedSample&& compressed_sample) {
+        if constexpr (std::is_invocable_v<CompressedSample&>) {
+            if (m_compressed) {
+                return compressed_samples(samples, deadline,
+                                          compressed_sample);
+            }
+        }
+
+        solution_t best;
+        cost_type best_cost = -1;
+        for (size_t i = 0; i < samples && (i == 0 || !deadline.expired());
+             i++) {
+            auto solution = sample();
+            if (m_options.reorder_levels) {
+                solution = reorder::smith(m_instance, std::move(solution));
+            }
+            cost_type cost = m_instance.cost(solution);
+            report(0, cost);
+            m_initial.offer(solution, cost);
+            if (best_cost < 0 || cost < best_cost) {
+                best = std::move(solution);
+                best_cost = cost;
+            }
+        }
+        return best;
+    }
+
+  public:
+    /**
+     * Cria as fases de solução de uma instância. Caso `log` não seja nulo, o
+     * progresso das fases é escrito nele.
+     */
+    solver(const instance_t& instance, const options& opts,
+           std::ostream* log = nullptr)
+        : m_instance(instance), m_options(opts), m_log(log),
+          m_weight_stddev(
+              stddev(instance, [](const rect_t& r) { return r.weight; })),
+          m_height_stddev(
+              stddev(instance, [](const rect_t& r) { return r.height; })),
+          m_initial(opts.pool_size), m_best_cost(-1), m_reported(-1) {
+        if (m_log) {
+            *m_log << "Weight standard deviation: " << m_weight_stddev
+                   << std::endl;
+            *m_log << "Height standard deviation: " << m_height_stddev
+                   << std::endl;
+        }
+        if (m_options.compress) {
+            m_compressed = compress::compress(instance);
+            if (m_log) {
+                *m_log << "Compressed " << instance.rects.size()
+                       << " rectangles into " << m_compressed->classes.size()
+                       << " classes" << std::endl;
+            }
+        }
+    }
+
+    /*! Define a ação executada a cada nova melhor solução. */
+    void set_progress(progress_callback on_progress) {
+        m_on_progress = std::move(on_progress);
+    }
+
+    const options& opts() const { return m_options; }
+
+    /*! Conjunto de soluções iniciais do BRKGA. */
+    const pool::solution_pool& initial() const { return m_initial; }
+
+    /*! Melhor solução dentre todas as fases (vazia se não houver). */
+    const solution_t& best() const { return m_best; }
+
+    /*! Atualiza a melhor solução dentre todas as fases. O(n). */
+    void offer(const solution_t& solution) {
+        if (solution.empty()) {
+            return;
+        }
+        cost_type cost = m_instance.cost(solution);
+        report(0, cost);
+        if (m_best_cost < 0 || cost < m_best_cost) {
+            m_best = solution;
+            m_best_cost = cost;
+        }
+    }
+
+    /*! Gera soluções com a heurística de first-fit aleatorizada. */
+    template <class URBG>
+    solution_t first_fit(URBG&& rng, const util::deadline& deadline) {
+        std::normal_distribution<> noise(
+            0.0, m_options.first_fit_deviations * m_weight_stddev);
+        return samples(
+            m_options.first_fit_samples, deadline,
+            [&] {
+                return heuristics::constructive::
+                    randomized_first_fit_decreasing_density(m_instance, rng,
+                                                            noise);
+            },
+            [&] {
+                return compress::randomized_first_fit_decreasing_density(
+                    *m_compressed, rng, noise);
+            });
+    }
+
+    /*! Gera soluções com a heurística de best-fit aleatorizada. */
+    template <class URBG>
+    solution_t best_fit(URBG&& rng, const util::deadline& deadline) {
+        std::normal_distribution<> noise(
+            0.0, m_options.best_fit_deviations * m_height_stddev);
+        return samples(
+            m_options.best_fit_samples, deadline,
+            [&] {
+                return heuristics::constructive::
+                    randomized_best_fit_increasing_height(m_instance, rng,
+                                                          noise);
+            },
+            [&] {
+                return compress::randomized_best_fit_increasing_height(
+                    *m_compressed, rng, noise);
+            });
+    }
+
+    /**
+     * Gera soluções com uma heurística construtiva de nome dado (veja
+     * `heuristics::constructive::engine`). As amostras não usam a instância
+     * comprimida, e heurísticas sem ruído geram uma única amostra.
+     */
+    template <class URBG>
+    solution_t heuristic(const std::string& name, URBG&& rng,
+                         const util::deadline& deadline) {
+        return heuristics::constructive::with_heuristic(
+            name, [&]<typename Engine>() {
+                std::normal_distribution<> noise(
+                    0.0, m_options.heuristic_deviations *
+                             Engine::spread(m_instance));
+                return samples(
+                    Engine::randomized ? m_options.heuristic_samples : 1,
+                    deadline,
+                    [&] { return Engine::sample(m_instance, rng, noise); },
+                    nullptr);
+            });
+    }
+
+    /**
+     * Gera soluções com o portfólio adaptativo de heurísticas construtivas,
+     * que distribui as amostras de ambas as heurísticas entre elas e seus
+     * níveis de ruído conforme os resultados.
+     */
+    template <class URBG>
+    constructive_result portfolio(URBG&& rng,
+                                  const util::deadline& deadline) {
+        portfolio::scheduler scheduler(
+            m_instance,
+            portfolio::default_arms(m_options.first_fit_deviations,
+                                    m_options.best_fit_deviations),
+            m_weight_stddev, m_height_stddev);
+        if (m_compressed) {
+            scheduler.set_compressed(&*m_compressed);
+        }
+        scheduler.set_reorder(m_options.reorder_levels);
+        scheduler.run(rng,
+                      m_options.first_fit_samples + m_options.best_fit_samples,
+                      m_options.threads, m_initial, deadline,
+                      [this](cost_type cost) { report(0, cost); });
+
+        for (size_t i = 0; m_log && i < scheduler.arms().size(); i++) {
+            const auto& arm = scheduler.arms()[i];
+            const auto& stats = scheduler.stats()[i];
+            *m_log << "Portfolio: "
+                   << (arm.kind == portfolio::heuristic::first_fit
+                           ? "first-fit"
+                           : "best-fit")
+                   << " with " << arm.deviations << " deviations: "
+                   << stats.samples << " samples, " << stats.rewards
+                   << " elite, best " << stats.best << std::endl;
+        }
+
+        return {scheduler.best(portfolio::heuristic::first_fit),
+                scheduler.best(portfolio::heuristic::best_fit)};
+    }
+
+    /**
+     * Executa todas as heurísticas construtivas configuradas: o portfólio
+     * ou o first-fit e o best-fit, seguidos das heurísticas extras. O prazo
+     * é dividido igualmente entre as fases, com o que sobrar de cada uma
+     * passando às seguintes.
+     */
+    template <class URBG>
+    constructive_result constructive(URBG&& rng,
+                                     const util::deadline& deadline) {
+        size_t phases =
+            m_options.heuristics.size() + (m_options.portfolio ? 1 : 2);
+        auto next_phase = [&] { return deadline.slice(1.0 / phases--); };
+
+        constructive_result result;
+        if (m_options.portfolio) {
+            result = portfolio(rng, next_phase());
+        } else {
+            result.first_fit = first_fit(rng, next_phase());
+            result.best_fit = best_fit(rng, next_phase());
+        }
+        offer(result.first_fit);
+        offer(result.best_fit);
+
+        for (const auto& name : m_options.heuristics) {
+            auto solution = heuristic(name, rng, next_phase());
+            if (m_log) {
+                *m_log << "Heuristic " << name << ": best "
+                       << m_instance.cost(solution) << std::endl;
+            }
+            offer(solution);
+        }
+
+        if (m_log) {
+            *m_log << "Initial pool: " << m_initial.size() << " of "
+                   << m_initial.offered() << " solutions ("
+                   << m_initial.duplicates() << " duplicates)" << std::endl;
+        }
+        return result;
+    }
+
+    /**
+     * Melhora as soluções iniciais com o BRKGA, consumindo o conjunto de
+     * soluções iniciais. Antes da execução, `configure` é chamada com o
+     * algoritmo e os seus parâmetros, para configurações adicionais.
+     *
+     * Devolve a melhor solução obtida pelo BRKGA.
+     */
+    template <class URBG, class Configure>
+    solution_t improve(URBG&& rng, BRKGA::BrkgaParams brkga_params,
+                       const BRKGA::ControlParams& control_params,
+                       const util::deadline& deadline,
+                       Configure&& configure) {
+        // Garante que cada população seja composta inicialmente por, no
+        // máximo, 50% de soluções heurísticas. Usamos o número de amostras
+        // efetivamente geradas, que pode ser menor que o configurado caso o
+        // prazo das heurísticas construtivas tenha expirado.
+        brkga_params.population_size =
+            std::max(brkga_params.population_size,
+                     unsigned(m_initial.size()) * 2 /
+                         brkga_params.num_independent_populations);
+
+        return heuristics::improvement::with_decoder(
+            m_options.decoder, m_options.reorder_levels,
+            [&]<typename Decoder>() {
+                heuristics::improvement::brkga_mp_ipr<Decoder> brkga(
+                    m_instance, m_initial.take(rng));
+                brkga.set_log(m_log);
+                brkga.set_bounded_decode(m_options.bounded_decode);
+                brkga.set_intensification(m_options.intensify);
+                brkga.set_adaptive(m_options.adaptive);
+                brkga.set_observer(
+                    [this](const BRKGA::AlgorithmStatus& status) {
+                        report(status.current_iteration,
+                               status.best_fitness);
+                    });
+                configure(brkga, brkga_params);
+                return brkga.run(rng, brkga_params, control_params,
+                                 m_options.brkga_threads, deadline);
+            });
+    }
+
+    /*! Melhora as soluções iniciais com o BRKGA (veja acima). */
+    template <class URBG>
+    solution_t improve(URBG&& rng, const BRKGA::BrkgaParams& brkga_params,
+                       const BRKGA::ControlParams& control_params,
+                       const util::deadline& deadline) {
+        return improve(rng, brkga_params, control_params, deadline,
+                       [](auto&, auto&) {});
+    }
+};
+
+/**
+ * Resolve uma instância com as heurísticas construtivas aleatorizadas,
+ * seguidas do BRKGA inicializado com as melhores soluções delas, dentro de um
+ * prazo.
+ *
+ * É a mesma sequência do executável de heurísticas (veja `solver`), sem
+ * escrita de arquivos. Com as opções padrão, roda em uma única thread, de
+ * forma que várias instâncias podem ser resolvidas em paralelo.
+ */
+template <typename URBG>
+solution_t solve(const instance_t& instance, const options& opts,
+                 const BRKGA::BrkgaParams& brkga_params,
+                 const BRKGA::ControlParams& control_params, URBG&& rng,
+                 const util::deadline& deadline,
+                 const progress_callback& on_progress = {}) {
+    solver s(instance, opts);
+    s.set_progress(on_progress);
+    s.constructive(rng, deadline.slice(opts.brkga ? opts.constructive_fraction
+                                                  : 1.0));
+    if (opts.brkga && !deadline.expired()) {
+        s.offer(s.improve(rng, brkga_params, control_params, deadline));
+    }
+    return s.best();
+}
+
+} // namespace strip_packing::pipeline
+
+#endif // STRIP_PACKING_PIPELINE_HPP
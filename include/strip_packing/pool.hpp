@@ -0,0 +1,180 @@
+#ifndef STRIP_PACKING_POOL_HPP
+#define STRIP_PACKING_POOL_HPP
+
+#include "defs.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace strip_packing::pool {
+
+/**
+ * Conjunto limitado das melhores soluções distintas geradas pelas heurísticas
+ * construtivas, usado como população inicial do BRKGA.
+ *
+ * Como os cromossomos só codificam a ordem de inserção dos retângulos, cada
+ * solução é armazenada de forma compacta como essa ordem (os índices dos
+ * retângulos nível a nível), com 4 bytes por retângulo. Soluções com a mesma
+ * ordem são descartadas, comparando um hash de 64 bits da ordem.
+ *
+ * O conjunto guarda no máximo `capacity` soluções, descartando as de maior
+ * custo, e pode ser alimentado conforme as soluções são geradas: soluções
+ * piores que todas as do conjunto cheio são rejeitadas sem serem codificadas.
+ * Assim, a memória usada é O(K n), independente do número de amostras.
+ *
+ * O conjunto não é thread-safe.
+ */
+class solution_pool {
+  public:
+    using order_t = std::vector<uint32_t>;
+
+  private:
+    /*! Solução armazenada. */
+    struct entry {
+        cost_type cost;
+        uint64_t hash;
+        order_t order;
+
+        bool operator<(const entry& other) const { return cost < other.cost; }
+    };
+
+    size_t m_capacity;
+    std::vector<entry> m_heap;             /// Max-heap por custo
+    std::unordered_set<uint64_t> m_hashes; /// Hashes das soluções no conjunto
+    size_t m_offered;                      /// Soluções oferecidas
+    size_t m_duplicates;                   /// Soluções repetidas descartadas
+
+    /*! Hash de uma ordem de inserção (FNV-1a com mistura final). O(n). */
+    static uint64_t hash(const order_t& order) {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (uint32_t index : order) {
+            h = (h ^ index) * 0x100000001b3ull;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+  public:
+    solution_pool(size_t capacity)
+        : m_capacity(capacity), m_offered(0), m_duplicates(0) {
+        m_heap.reserve(capacity);
+    }
+
+    size_t size() const { return m_heap.size(); }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_heap.empty(); }
+
+    /*! Número de soluções oferecidas ao conjunto. */
+    size_t offered() const { return m_offered; }
+
+    /*! Número de soluções descartadas por serem repetidas. */
+    size_t duplicates() const { return m_duplicates; }
+
+    /**
+     * Oferece uma solução de custo conhecido ao conjunto. Devolve se ela foi
+     * inserida. O(n + lg K).
+     */
+    bool offer(const solution_t& solution, cost_type cost) {
+        return offer(cost, [&]() -> const solution_t& { return solution; });
+    }
+
+    /**
+     * Oferece uma solução de custo conhecido ao conjunto, construída por
+     * `make` apenas caso o custo permita que ela entre no conjunto (por
+     * exemplo, expandindo uma solução comprimida). Devolve se ela foi
+     * inserida.
+     */
+    template <typename F> bool offer(cost_type cost, F&& make) {
+        if (!admit(cost)) {
+            return false;
+        }
+        return insert(cost, encode(make()));
+    }
+
+    /*! Solução codificada para o conjunto (veja `encode`). */
+    struct candidate {
+        uint64_t hash;
+        order_t order;
+    };
+
+    /**
+     * Codifica uma solução para ser inserida com `insert`. Não acessa o
+     * conjunto, então pode ser chamada fora de uma seção crítica quando o
+     * conjunto é compartilhado entre threads. O(n).
+     */
+    static candidate encode(const solution_t& solution) {
+        order_t order;
+        for (const auto& level : solution) {
+            order.insert(order.end(), level.begin(), level.end());
+        }
+        uint64_t h = hash(order);
+        return {h, std::move(order)};
+    }
+
+    /**
+     * Verifica se uma solução de custo dado pode entrar no conjunto (a menos
+     * de repetições). Caso não possa, ela é contada como oferecida e
+     * recusada, e não deve ser passada a `insert`. O(1).
+     */
+    bool admit(cost_type cost) {
+        bool full = m_heap.size() >= m_capacity;
+        if (m_capacity == 0 || (full && !(cost < m_heap.front().cost))) {
+            m_offered++;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Oferece uma solução já codificada ao conjunto. Devolve se ela foi
+     * inserida. O(lg K).
+     */
+    bool insert(cost_type cost, candidate c) {
+        m_offered++;
+        bool full = m_heap.size() >= m_capacity;
+        if (m_capacity == 0 || (full && !(cost < m_heap.front().cost))) {
+            return false;
+        }
+        if (!m_hashes.insert(c.hash).second) {
+            m_duplicates++;
+            return false;
+        }
+
+        if (full) {
+            std::pop_heap(m_heap.begin(), m_heap.end());
+            m_hashes.erase(m_heap.back().hash);
+            m_heap.pop_back();
+        }
+        m_heap.push_back({cost, c.hash, std::move(c.order)});
+        std::push_heap(m_heap.begin(), m_heap.end());
+        return true;
+    }
+
+    /**
+     * Esvazia o conjunto, devolvendo as ordens de inserção das soluções em
+     * ordem aleatória (para que soluções de heurísticas diferentes sejam
+     * distribuídas entre as populações).
+     */
+    template <typename URBG> std::vector<order_t> take(URBG&& rng) {
+        std::vector<order_t> orders;
+        orders.reserve(m_heap.size());
+        for (auto& e : m_heap) {
+            orders.push_back(std::move(e.order));
+        }
+        m_heap.clear();
+        m_hashes.clear();
+        std::shuffle(orders.begin(), orders.end(), rng);
+        return orders;
+    }
+};
+
+} // namespace strip_packing::pool
+
+#endif // STRIP_PACKING_POOL_HPP
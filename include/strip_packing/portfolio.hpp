@@ -0,0 +1,364 @@
+#ifndef STRIP_PACKING_PORTFOLIO_HPP
+#define STRIP_PACKING_PORTFOLIO_HPP
+
+#include "compress.hpp"
+#include "defs.hpp"
+#include "heuristics.hpp"
+#include "pool.hpp"
+#include "reorder.hpp"
+
+#include "util/deadline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace strip_packing::portfolio {
+
+/*! Heurística construtiva aleatorizada. */
+enum class heuristic {
+    first_fit, /// First-fit em ordem decrescente de densidade
+    best_fit,  /// Best-fit em ordem crescente de altura
+};
+
+/*! Braço do portfólio: uma heurística com um nível de ruído. */
+struct arm {
+    heuristic kind;    /// Heurística
+    double deviations; /// Desvios padrão do ruído aplicado à instância
+};
+
+/*! Estatísticas de um braço ao fim da execução. */
+struct arm_stats {
+    size_t samples = 0;  /// Amostras geradas
+    size_t rewards = 0;  /// Amostras que entraram na elite
+    cost_type best = -1; /// Custo da melhor amostra (-1 se não houver)
+};
+
+/**
+ * Bandido multibraço com UCB1 descontado.
+ *
+ * Cada recompensa observada reduz o peso das observações anteriores por um
+ * fator de desconto, de forma que a escolha acompanha o braço que está
+ * produzindo melhorias no momento (e não o que produziu no começo). Braços
+ * ainda não testados são escolhidos primeiro. Amostras em andamento contam
+ * como observações sem recompensa, para que várias threads não escolham todas
+ * o mesmo braço antes de qualquer resultado.
+ */
+class discounted_ucb {
+  private:
+    double m_discount;
+    double m_exploration;
+
+    std::vector<double> m_count;   /// Observações descontadas
+    std::vector<double> m_reward;  /// Recompensas descontadas
+    std::vector<size_t> m_pending; /// Amostras em andamento
+
+  public:
+    discounted_ucb(size_t arms, double discount = 0.995,
+                   double exploration = 0.5)
+        : m_discount(discount), m_exploration(exploration), m_count(arms, 0),
+          m_reward(arms, 0), m_pending(arms, 0) {}
+
+    /*! Escolhe o próximo braço. O(k). */
+    size_t select() {
+        double total = 0;
+        for (size_t i = 0; i < m_count.size(); i++) {
+            total += m_count[i] + m_pending[i];
+        }
+
+        size_t chosen = 0;
+        double best_score = -std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < m_count.size(); i++) {
+            double n = m_count[i] + m_pending[i];
+            double score = std::numeric_limits<double>::infinity();
+            if (n > 0) {
+                score = m_reward[i] / n +
+                        m_exploration *
+                            std::sqrt(2 * std::log(std::max(total, 1.0)) / n);
+            }
+            if (score > best_score) {
+                best_score = score;
+                chosen = i;
+            }
+        }
+        m_pending[chosen]++;
+        return chosen;
+    }
+
+    /*! Registra a recompensa de uma amostra do braço dado. O(k). */
+    void update(size_t arm, double reward) {
+        for (size_t i = 0; i < m_count.size(); i++) {
+            m_count[i] *= m_discount;
+            m_reward[i] *= m_discount;
+        }
+        m_pending[arm]--;
+        m_count[arm] += 1;
+        m_reward[arm] += reward;
+    }
+};
+
+/**
+ * Escalonador adaptativo de heurísticas construtivas.
+ *
+ * Em vez de dividir as amostras de forma fixa entre as heurísticas, cada
+ * amostra é atribuída por um bandido multibraço a uma combinação de
+ * heurística e nível de ruído. Uma amostra é recompensada quando entra na
+ * elite das melhores soluções geradas até então (as `elite_size` de menor
+ * custo), de forma que o orçamento se concentra nos braços que estão gerando
+ * boas soluções para a população inicial do BRKGA.
+ *
+ * As amostras são geradas em paralelo por várias threads, que só
+ * sincronizam para escolher um braço e registrar o resultado.
+ */
+class scheduler {
+  private:
+    const instance_t& m_instance;
+    std::vector<arm> m_arms;
+    double m_weight_stddev;
+    double m_height_stddev;
+    size_t m_elite_size;
+    const compress::compressed_instance* m_compressed;
+    bool m_reorder; /// Se os níveis das amostras são reordenados
+
+    std::mutex m_mutex;
+    discounted_ucb m_bandit;
+    std::priority_queue<cost_type> m_elite; /// Custos da elite (max-heap)
+    std::vector<arm_stats> m_stats;
+    std::vector<solution_t> m_best;         /// Melhor solução por heurística
+    std::vector<compress::compressed_solution>
+        m_best_compressed; /// Melhor solução comprimida por heurística
+    std::vector<cost_type> m_best_cost;
+
+    template <typename URBG>
+    solution_t sample(const arm& a, URBG&& rng) const {
+        using namespace heuristics::constructive;
+        if (a.kind == heuristic::first_fit) {
+            std::normal_distribution<> noise(0.0,
+                                             a.deviations * m_weight_stddev);
+            return randomized_first_fit_decreasing_density(m_instance, rng,
+                                                           noise);
+        } else {
+            std::normal_distribution<> noise(0.0,
+                                             a.deviations * m_height_stddev);
+            return randomized_best_fit_increasing_height(m_instance, rng,
+                                                         noise);
+        }
+    }
+
+    template <typename URBG>
+    compress::compressed_solution sample_compressed(const arm& a,
+                                                    URBG&& rng) const {
+        if (a.kind == heuristic::first_fit) {
+            std::normal_distribution<> noise(0.0,
+                                             a.deviations * m_weight_stddev);
+            return compress::randomized_first_fit_decreasing_density(
+                *m_compressed, rng, noise);
+        } else {
+            std::normal_distribution<> noise(0.0,
+                                             a.deviations * m_height_stddev);
+            return compress::randomized_best_fit_increasing_height(
+                *m_compressed, rng, noise);
+        }
+    }
+
+    /**
+     * Registra o custo de uma amostra do braço dado. Devolve se ela é a
+     * melhor da sua heurística até então. Deve ser chamada com o mutex
+     * travado.
+     */
+    bool record(size_t i, cost_type cost) {
+        bool elite = m_elite.size() < m_elite_size || cost < m_elite.top();
+        if (elite) {
+            m_elite.push(cost);
+            if (m_elite.size() > m_elite_size) {
+                m_elite.pop();
+            }
+        }
+        m_bandit.update(i, elite ? 1.0 : 0.0);
+
+        auto& stats = m_stats[i];
+        stats.samples++;
+        stats.rewards += elite;
+        if (stats.best < 0 || cost < stats.best) {
+            stats.best = cost;
+        }
+
+        size_t kind = size_t(m_arms[i].kind);
+        if (m_best_cost[kind] < 0 || cost < m_best_cost[kind]) {
+            m_best_cost[kind] = cost;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Registra uma amostra do braço dado e a oferece ao conjunto de soluções
+     * iniciais. O mutex só é travado para o registro e para a inserção no
+     * conjunto: a solução é construída por `make` (por exemplo, expandida)
+     * e codificada fora dele, e apenas caso o custo permita que ela entre
+     * no conjunto. A amostra é copiada para `best` quando é a melhor da sua
+     * heurística, e o custo é passado a `on_sample` (se não for vazia) com o
+     * mutex travado.
+     */
+    template <typename Solution, typename Make>
+    void offer(size_t i, cost_type cost, const Solution& solution,
+               std::vector<Solution>& best, pool::solution_pool& pool,
+               const std::function<void(cost_type)>& on_sample, Make&& make) {
+        bool admitted;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (on_sample) {
+                on_sample(cost);
+            }
+            admitted = pool.admit(cost);
+            if (record(i, cost)) {
+                best[size_t(m_arms[i].kind)] = solution;
+            }
+        }
+        if (!admitted) {
+            return;
+        }
+
+        auto candidate = pool::solution_pool::encode(make());
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pool.insert(cost, std::move(candidate));
+    }
+
+    /**
+     * Gera uma amostra do braço dado e a registra. Com a instância
+     * comprimida, a amostra e o seu custo são calculados sobre as classes,
+     * e ela só é expandida caso entre no conjunto de soluções iniciais.
+     */
+    template <typename URBG>
+    void sample_and_record(size_t i, URBG&& rng, pool::solution_pool& pool,
+                           const std::function<void(cost_type)>& on_sample) {
+        if (m_compressed) {
+            auto solution = sample_compressed(m_arms[i], rng);
+            if (m_reorder) {
+                solution = compress::smith(*m_compressed, std::move(solution));
+            }
+            offer(i, m_compressed->cost(solution), solution, m_best_compressed,
+                  pool, on_sample,
+                  [&] { return compress::expand(*m_compressed, solution); });
+        } else {
+            auto solution = sample(m_arms[i], rng);
+            if (m_reorder) {
+                solution = reorder::smith(m_instance, std::move(solution));
+            }
+            offer(i, m_instance.cost(solution), solution, m_best, pool,
+                  on_sample, [&]() -> const solution_t& { return solution; });
+        }
+    }
+
+  public:
+    /**
+     * Cria o escalonador.
+     *
+     * Os níveis de ruído dos braços são dados em desvios padrão do peso (para
+     * o first-fit) ou da altura (para o best-fit) dos retângulos.
+     */
+    scheduler(const instance_t& instance, std::vector<arm> arms,
+              double weight_stddev, double height_stddev,
+              size_t elite_size = 32)
+        : m_instance(instance), m_arms(std::move(arms)),
+          m_weight_stddev(weight_stddev), m_height_stddev(height_stddev),
+          m_elite_size(std::max<size_t>(1, elite_size)),
+          m_compressed(nullptr), m_reorder(false),
+          m_bandit(m_arms.size()), m_stats(m_arms.size()), m_best(2),
+          m_best_compressed(2), m_best_cost(2, -1) {}
+
+    /**
+     * Gera as amostras sobre uma instância comprimida, equivalente à
+     * instância do escalonador.
+     */
+    void set_compressed(const compress::compressed_instance* compressed) {
+        m_compressed = compressed;
+    }
+
+    /**
+     * Define se os níveis de cada amostra são reordenados pela regra de
+     * Smith (veja `reorder::smith`) antes do cálculo do custo.
+     */
+    void set_reorder(bool reorder) { m_reorder = reorder; }
+
+    const std::vector<arm>& arms() const { return m_arms; }
+    const std::vector<arm_stats>& stats() const { return m_stats; }
+
+    /*! Melhor solução gerada por uma heurística (vazia se não houver). */
+    solution_t best(heuristic kind) const {
+        if (m_compressed) {
+            return compress::expand(*m_compressed,
+                                    m_best_compressed[size_t(kind)]);
+        }
+        return m_best[size_t(kind)];
+    }
+
+    /**
+     * Gera até `samples` soluções usando `threads` threads, oferecendo-as ao
+     * conjunto de soluções iniciais `pool`. O custo de cada amostra é
+     * passado a `on_sample`, uma amostra por vez.
+     *
+     * A geração é interrompida quando o prazo expira, mas pelo menos uma
+     * amostra é sempre gerada.
+     */
+    template <typename URBG>
+    void run(URBG&& rng, size_t samples, unsigned threads,
+             pool::solution_pool& pool, const util::deadline& deadline,
+             const std::function<void(cost_type)>& on_sample = nullptr) {
+        threads = std::max(1u, threads);
+
+        size_t started = 0;
+        auto worker = [&](unsigned seed) {
+            std::minstd_rand local_rng(seed);
+            while (true) {
+                size_t i;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (started >= samples ||
+                        (started > 0 && deadline.expired())) {
+                        return;
+                    }
+                    started++;
+                    i = m_bandit.select();
+                }
+                sample_and_record(i, local_rng, pool, on_sample);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++) {
+            workers.emplace_back(worker, unsigned(rng()));
+        }
+        worker(unsigned(rng()));
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    }
+};
+
+/**
+ * Braços padrão do portfólio: cada heurística com metade, o mesmo e o dobro
+ * do nível de ruído configurado.
+ */
+inline std::vector<arm> default_arms(double first_fit_deviations,
+                                     double best_fit_deviations) {
+    std::vector<arm> arms;
+    for (double factor : {0.5, 1.0, 2.0}) {
+        arms.push_back({heuristic::first_fit, factor * first_fit_deviations});
+    }
+    for (double factor : {0.5, 1.0, 2.0}) {
+        arms.push_back({heuristic::best_fit, factor * best_fit_deviations});
+    }
+    return arms;
+}
+
+} // namespace strip_packing::portfolio
+
+#endif // STRIP_PACKING_PORTFOLIO_HPP
@@ -3,7 +3,15 @@
 
 #include "defs.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <blend2d.h>
 
@@ -119,9 +127,406 @@ class solution_renderer {
     }
 };
 
+/*! Primitiva de desenho do renderizador com nível de detalhe. */
+struct primitive {
+    enum kind_t : uint8_t {
+        rect, /// Retângulo individual, com contorno
+        span, /// Agregado de retângulos pequenos, sem contorno
+        line, /// Linha separadora horizontal de (x, y) a (x + w, y)
+    };
+
+    kind_t kind;
+    float x, y, w, h; /// Posição e tamanho na imagem (em pixels)
+    uint8_t alpha;    /// Intensidade do vermelho (pelo peso médio)
+};
+
+/*! Opções do renderizador com nível de detalhe. */
+struct lod_options {
+    double scale = 8;          /// Pixels por unidade de comprimento
+    double max_height = 5000;  /// Altura máxima da figura (em pixels)
+    double padding = 24;       /// Margem ao redor da figura (em pixels)
+    double min_detail = 1;     /// Tamanho mínimo de um retângulo individual
+    unsigned tile_height = 256; /// Altura das faixas renderizadas em paralelo
+    unsigned threads = 0;      /// Threads (0 para o número de núcleos)
+};
+
+/**
+ * Renderizador de soluções com nível de detalhe, para soluções grandes.
+ *
+ * Retângulos menores que `min_detail` pixels (em largura ou altura) não são
+ * desenhados individualmente: retângulos consecutivos de um nível são
+ * agregados em trechos de pelo menos `min_detail` pixels, e níveis
+ * consecutivos mais baixos que isso são agregados em faixas, com cada coluna
+ * de pixels colorida pelo peso médio (ponderado pela área) dos retângulos
+ * que a cobrem. Assim, o número de primitivas desenhadas é limitado pelo
+ * tamanho da imagem, e não pelo número de retângulos.
+ *
+ * As primitivas são geradas em uma única passada pelos níveis, O(n + P),
+ * onde P é o número de pixels da imagem. A imagem é renderizada em faixas
+ * horizontais em paralelo, cada uma com seu contexto, sobre a mesma memória.
+ * A saída em SVG escreve cada primitiva assim que ela é gerada, sem guardar
+ * a lista.
+ */
+class lod_renderer {
+  private:
+    constexpr static BLRgba32 WHITE = BLRgba32(0xFFFFFFFF);
+    constexpr static BLRgba32 BLACK = BLRgba32(0xFF000000);
+
+    const instance_t& m_instance;
+    const solution_t& m_solution;
+    lod_options m_options;
+
+    dim_type m_recipient_height;
+    cost_type m_max_weight;
+    double m_scale;
+
+    double figure_width() const {
+        return m_instance.recipient_length * m_scale;
+    }
+    double figure_height() const { return m_recipient_height * m_scale; }
+
+    double image_width() const {
+        return std::ceil(figure_width() + 2 * m_options.padding);
+    }
+    double image_height() const {
+        return std::ceil(figure_height() + 2 * m_options.padding);
+    }
+
+    /*! Intensidade do vermelho para um peso, como em `solution_renderer`. */
+    uint8_t alpha(cost_type weight) const {
+        return std::round(0xFF *
+                          (m_max_weight > 0 ? weight / m_max_weight : 1));
+    }
+
+    /**
+     * Agregador de níveis baixos em uma faixa da imagem. Acumula, para cada
+     * coluna de pixels, a área coberta e a área ponderada pelo peso. As
+     * colunas inteiramente cobertas por um retângulo são acumuladas em
+     * vetores de diferenças, de forma que cada retângulo custa O(1).
+     */
+    struct row_accumulator {
+        std::vector<double> area, weighted, area_diff, weighted_diff;
+        double height = 0; /// Altura acumulada da faixa (em pixels)
+
+        row_accumulator(size_t columns)
+            : area(columns + 1), weighted(columns + 1),
+              area_diff(columns + 2), weighted_diff(columns + 2) {}
+
+        /*! Adiciona um retângulo de x0 a x1 (em pixels da figura). */
+        void add(double x0, double x1, double h, cost_type weight) {
+            size_t last = area.size() - 1;
+            size_t c0 = std::min(size_t(x0), last);
+            size_t c1 = std::min(size_t(x1), last);
+            if (c0 == c1) {
+                area[c0] += (x1 - x0) * h;
+                weighted[c0] += (x1 - x0) * h * weight;
+                return;
+            }
+            area[c0] += (c0 + 1 - x0) * h;
+            weighted[c0] += (c0 + 1 - x0) * h * weight;
+            area[c1] += (x1 - c1) * h;
+            weighted[c1] += (x1 - c1) * h * weight;
+            area_diff[c0 + 1] += h;
+            area_diff[c1] -= h;
+            weighted_diff[c0 + 1] += h * weight;
+            weighted_diff[c1] -= h * weight;
+        }
+
+        bool empty() const { return height == 0; }
+
+        /*! Emite os trechos da faixa e a esvazia. */
+        template <typename Sink>
+        void flush(const lod_renderer& r, double x, double y, Sink&& sink) {
+            double a = 0, w = 0;
+            size_t start = 0;
+            int current = -1;
+            auto emit = [&](size_t end) {
+                if (current >= 0) {
+                    sink(primitive{primitive::span, float(x + start),
+                                   float(y - height), float(end - start),
+                                   float(height), uint8_t(current)});
+                }
+            };
+            for (size_t c = 0; c < area.size(); c++) {
+                a += area_diff[c];
+                w += weighted_diff[c];
+                double col_area = area[c] + a, col_weighted = weighted[c] + w;
+                int value = col_area > 1e-9
+                                ? r.alpha(col_weighted / col_area)
+                                : -1;
+                if (value != current) {
+                    emit(c);
+                    start = c;
+                    current = value;
+                }
+            }
+            emit(area.size());
+
+            std::fill(area.begin(), area.end(), 0);
+            std::fill(weighted.begin(), weighted.end(), 0);
+            std::fill(area_diff.begin(), area_diff.end(), 0);
+            std::fill(weighted_diff.begin(), weighted_diff.end(), 0);
+            height = 0;
+        }
+    };
+
+    /**
+     * Gera as primitivas da solução, de baixo para cima, chamando
+     * `sink(primitive)` para cada uma. O(n + P).
+     */
+    template <typename Sink> void build(Sink&& sink) const {
+        double min_detail = m_options.min_detail;
+        double x0 = m_options.padding;
+        double y = image_height() - m_options.padding;
+        row_accumulator row(std::ceil(figure_width()));
+
+        for (const auto& level : m_solution) {
+            dim_type level_height = 0;
+            for (auto i : level) {
+                level_height =
+                    std::max(level_height, m_instance.rects[i].height);
+            }
+            double level_px = level_height * m_scale;
+
+            // Níveis baixos são agregados em uma faixa.
+            if (level_px < min_detail) {
+                double x = 0;
+                for (auto i : level) {
+                    const auto& rect = m_instance.rects[i];
+                    double w = rect.length * m_scale;
+                    row.add(x, x + w, rect.height * m_scale, rect.weight);
+                    x += w;
+                }
+                row.height += level_px;
+                if (row.height >= min_detail) {
+                    double height = row.height;
+                    row.flush(*this, x0, y, sink);
+                    y -= height;
+                }
+                continue;
+            }
+            if (!row.empty()) {
+                double height = row.height;
+                row.flush(*this, x0, y, sink);
+                y -= height;
+            }
+
+            // Nos demais níveis, retângulos pequenos consecutivos são
+            // agregados em trechos.
+            double x = x0, span_x = x0, span_area = 0, span_weighted = 0;
+            double span_height = 0;
+            auto flush_span = [&] {
+                if (x > span_x) {
+                    sink(primitive{primitive::span, float(span_x),
+                                   float(y - span_height), float(x - span_x),
+                                   float(span_height),
+                                   alpha(span_area > 0
+                                             ? span_weighted / span_area
+                                             : 0)});
+                }
+                span_area = span_weighted = span_height = 0;
+            };
+            for (auto i : level) {
+                const auto& rect = m_instance.rects[i];
+                double w = rect.length * m_scale, h = rect.height * m_scale;
+                if (w >= min_detail && h >= min_detail) {
+                    flush_span();
+                    sink(primitive{primitive::rect, float(x), float(y - h),
+                                   float(w), float(h), alpha(rect.weight)});
+                    x += w;
+                    span_x = x;
+                    continue;
+                }
+                span_area += w * h;
+                span_weighted += w * h * rect.weight;
+                span_height = std::max(span_height, h);
+                x += w;
+                if (x - span_x >= min_detail) {
+                    flush_span();
+                    span_x = x;
+                }
+            }
+            flush_span();
+
+            y -= level_px;
+            sink(primitive{primitive::line, float(x0), float(y),
+                           float(figure_width()), 0, 0});
+        }
+        if (!row.empty()) {
+            row.flush(*this, x0, y, sink);
+        }
+    }
+
+    /*! Desenha uma primitiva. */
+    static void draw(BLContext& ctx, const primitive& p) {
+        switch (p.kind) {
+        case primitive::rect: {
+            BLRect rect(p.x, p.y, p.w, p.h);
+            ctx.setStrokeWidth(1);
+            ctx.fillRect(rect, BLRgba32(0xFF, 0x00, 0x00, p.alpha));
+            ctx.strokeRect(rect, BLACK);
+            break;
+        }
+        case primitive::span:
+            ctx.fillRect(BLRect(p.x, p.y, p.w, p.h),
+                         BLRgba32(0xFF, 0x00, 0x00, p.alpha));
+            break;
+        case primitive::line:
+            ctx.setStrokeWidth(2);
+            ctx.strokeLine(BLLine(p.x, p.y, p.x + p.w, p.y), BLACK);
+            break;
+        }
+    }
+
+  public:
+    lod_renderer(const instance_t& instance, const solution_t& solution,
+                 lod_options options = lod_options())
+        : m_instance(instance), m_solution(solution), m_options(options),
+          m_recipient_height(0), m_max_weight(0), m_scale(options.scale) {
+        for (const auto& level : m_solution) {
+            dim_type level_height = 0;
+            for (auto i : level) {
+                const auto& rect = m_instance.rects[i];
+                level_height = std::max(level_height, rect.height);
+                m_max_weight = std::max(m_max_weight, rect.weight);
+            }
+            m_recipient_height += level_height;
+        }
+        if (figure_height() > m_options.max_height) {
+            m_scale = m_options.max_height / m_recipient_height;
+        }
+    }
+
+    /*! Desenha a solução em faixas paralelas e salva em um arquivo. */
+    void render(const std::string& filename) const {
+        std::vector<primitive> primitives;
+        build([&](const primitive& p) { primitives.push_back(p); });
+
+        int width = image_width(), height = image_height();
+        int tile_height = std::max(1u, m_options.tile_height);
+        size_t tiles = (height + tile_height - 1) / tile_height;
+
+        // Distribui as primitivas entre as faixas que elas tocam (com uma
+        // margem para a espessura dos contornos), mantendo a ordem.
+        std::vector<std::vector<uint32_t>> buckets(tiles);
+        for (uint32_t i = 0; i < primitives.size(); i++) {
+            const auto& p = primitives[i];
+            int top = std::max(0.0f, p.y - 2) / tile_height;
+            int bottom = std::max(0.0f, p.y + p.h + 2) / tile_height;
+            for (int t = top; t <= bottom && t < int(tiles); t++) {
+                buckets[t].push_back(i);
+            }
+        }
+
+        BLImage img(width, height, BL_FORMAT_PRGB32);
+        BLImageData data;
+        img.makeMutable(&data);
+
+        std::atomic<size_t> next(0);
+        auto worker = [&] {
+            for (size_t t = next++; t < tiles; t = next++) {
+                int y0 = t * tile_height;
+                int h = std::min(tile_height, height - y0);
+                BLImage tile;
+                tile.createFromData(
+                    width, h, BL_FORMAT_PRGB32,
+                    static_cast<uint8_t*>(data.pixelData) + y0 * data.stride,
+                    data.stride);
+
+                BLContext ctx(tile);
+                ctx.clearAll();
+                ctx.translate(0, -y0);
+
+                BLRect recipient(m_options.padding, m_options.padding,
+                                 figure_width(), figure_height());
+                ctx.setStrokeWidth(4);
+                ctx.fillRect(recipient, WHITE);
+                ctx.strokeRect(recipient, BLACK);
+
+                for (uint32_t i : buckets[t]) {
+                    draw(ctx, primitives[i]);
+                }
+                ctx.end();
+            }
+        };
+
+        unsigned threads = m_options.threads;
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < std::min<size_t>(threads, tiles); i++) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        img.writeToFile(filename.c_str());
+    }
+
+    /*! Escreve a solução em SVG, primitiva a primitiva. */
+    void render_svg(std::ostream& out) const {
+        auto precision = out.precision();
+        auto flags = out.flags();
+        out.setf(std::ios::fixed);
+        out.precision(2);
+
+        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\""
+            << image_width() << "\" height=\"" << image_height()
+            << "\" shape-rendering=\"crispEdges\">\n";
+        out << "<rect x=\"" << m_options.padding << "\" y=\""
+            << m_options.padding << "\" width=\"" << figure_width()
+            << "\" height=\"" << figure_height()
+            << "\" fill=\"#fff\" stroke=\"#000\" stroke-width=\"4\"/>\n";
+
+        build([&](const primitive& p) {
+            if (p.kind == primitive::line) {
+                out << "<line x1=\"" << p.x << "\" y1=\"" << p.y
+                    << "\" x2=\"" << p.x + p.w << "\" y2=\"" << p.y
+                    << "\" stroke=\"#000\" stroke-width=\"2\"/>\n";
+                return;
+            }
+            out << "<rect x=\"" << p.x << "\" y=\"" << p.y << "\" width=\""
+                << p.w << "\" height=\"" << p.h << "\" fill=\"#f00\""
+                << " fill-opacity=\"" << p.alpha / 255.0 << "\"";
+            if (p.kind == primitive::rect) {
+                out << " stroke=\"#000\" stroke-width=\"1\"";
+            }
+            out << "/>\n";
+        });
+
+        out << "</svg>\n";
+        out.precision(precision);
+        out.flags(flags);
+    }
+
+    /*! Escreve a solução em um arquivo SVG. */
+    void render_svg(const std::string& filename) const {
+        std::ofstream out(filename);
+        render_svg(out);
+    }
+};
+
+/*! Número de retângulos a partir do qual o nível de detalhe é usado. */
+inline constexpr size_t LOD_THRESHOLD = 20000;
+
+/**
+ * Desenha uma solução e salva em um arquivo. Arquivos com extensão ".svg"
+ * são escritos em SVG; os demais são imagens, desenhadas com o renderizador
+ * com nível de detalhe caso a instância seja grande.
+ */
 static void render_solution(const instance_t& instance, solution_t solution,
                             std::string filename) {
-    solution_renderer(instance, solution).render(filename);
+    if (filename.size() >= 4 &&
+        filename.compare(filename.size() - 4, 4, ".svg") == 0) {
+        lod_renderer(instance, solution).render_svg(filename);
+    } else if (instance.rects.size() >= LOD_THRESHOLD) {
+        lod_renderer(instance, solution).render(filename);
+    } else {
+        solution_renderer(instance, solution).render(filename);
+    }
 }
 
 }; // namespace strip_packing::render
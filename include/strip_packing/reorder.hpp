@@ -0,0 +1,95 @@
+#ifndef STRIP_PACKING_REORDER_HPP
+#define STRIP_PACKING_REORDER_HPP
+
+#include "defs.hpp"
+
+#include "util/sort.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace strip_packing::reorder {
+
+/**
+ * Reordenação ótima dos níveis de uma solução.
+ *
+ * O custo de uma ordem de níveis é a soma, para cada nível, do seu peso total
+ * vezes a altura da sua base, isto é, o problema de sequenciamento 1||ΣwC (a
+ * menos de uma constante), para o qual a ordem crescente da razão entre
+ * altura e peso (regra de Smith) é ótima. Assim, qualquer heurística que
+ * fixa os níveis pode ser composta com a reordenação, sem nunca piorar o
+ * custo.
+ */
+
+/*! Resumo de um nível: altura e peso total. */
+struct level_summary {
+    dim_type height;
+    cost_type weight;
+};
+
+/*! Razão entre altura e peso de um nível, que define a ordem de Smith. */
+inline double smith_ratio(const level_summary& level) {
+    // Níveis sem peso ficam no topo (a menos dos que também não têm altura,
+    // que não afetam o custo).
+    if (level.weight > 0) {
+        return level.height / level.weight;
+    }
+    return level.height > 0 ? HUGE_VAL : 0;
+}
+
+/*! Ordem ótima de um conjunto de níveis. O(L lg L). */
+inline std::vector<size_t> smith_order(
+    const std::vector<level_summary>& levels) {
+    std::vector<double> ratios;
+    ratios.reserve(levels.size());
+    for (const auto& level : levels) {
+        ratios.push_back(smith_ratio(level));
+    }
+    return util::sort_permutation(ratios);
+}
+
+/**
+ * Custo ótimo de um conjunto de níveis, isto é, o custo deles na ordem de
+ * Smith. O(L lg L).
+ *
+ * O custo ótimo não diminui ao adicionar níveis ou ao aumentar o peso ou a
+ * altura de um nível, então o custo ótimo de uma solução parcial é uma cota
+ * inferior para o de qualquer solução que a complete.
+ */
+inline cost_type smith_cost(const std::vector<level_summary>& levels) {
+    cost_type total = 0;
+    dim_type base = 0;
+    for (size_t l : smith_order(levels)) {
+        total += levels[l].weight * base;
+        base += levels[l].height;
+    }
+    return total;
+}
+
+/*! Reordena os níveis de uma solução de forma ótima. O(L lg L + n). */
+inline solution_t smith(const instance_t& instance, solution_t solution) {
+    std::vector<level_summary> levels;
+    levels.reserve(solution.size());
+    for (const auto& level : solution) {
+        level_summary summary = {0, 0};
+        for (size_t i : level) {
+            summary.height = std::max(summary.height, instance.rects[i].height);
+            summary.weight += instance.rects[i].weight;
+        }
+        levels.push_back(summary);
+    }
+
+    solution_t ordered;
+    ordered.reserve(solution.size());
+    for (size_t l : smith_order(levels)) {
+        ordered.push_back(std::move(solution[l]));
+    }
+    return ordered;
+}
+
+} // namespace strip_packing::reorder
+
+#endif // STRIP_PACKING_REORDER_HPP
@@ -0,0 +1,219 @@
+#ifndef STRIP_PACKING_SERVICE_HPP
+#define STRIP_PACKING_SERVICE_HPP
+
+#include "defs.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace strip_packing::service {
+
+/**
+ * Protocolo do serviço de solução.
+ *
+ * As mensagens são trocadas com `util::send_frame` e `util::recv_frame`
+ * (prefixadas pelo seu tamanho), e têm formato binário na ordem de bytes
+ * nativa (cliente e serviço rodam na mesma máquina).
+ *
+ * Requisição (cliente para serviço):
+ *
+ *     "SPRQ" | id (u64) | prazo em segundos (f64) | semente (u64)
+ *     | largura do recipiente (f64) | n (u64) | n x (largura, altura, peso)
+ *
+ * Resposta (serviço para cliente), várias por requisição:
+ *
+ *     "SPRS" | id (u64) | tipo (u8) | tempo (f64) | iteração/posição (u32)
+ *     | custo (f64) | conteúdo
+ *
+ * Para cada requisição, o serviço envia uma resposta `accepted` (com a
+ * posição na fila), zero ou mais respostas `progress` (a cada nova melhor
+ * solução), e por fim uma resposta `solution` (cujo conteúdo é o número de
+ * níveis (u32) seguido, para cada nível, do número de retângulos (u32) e dos
+ * seus índices (u32)) ou `error` (cujo conteúdo é a mensagem de erro).
+ */
+
+/*! Tipo de resposta. */
+enum class response_kind : uint8_t {
+    accepted = 0, /// Requisição aceita e enfileirada
+    progress = 1, /// Nova melhor solução
+    solution = 2, /// Solução final
+    error = 3,    /// Erro ao processar a requisição
+};
+
+/*! Requisição de solução de uma instância. */
+struct request {
+    uint64_t id;       /// Identificador escolhido pelo cliente
+    double time_limit; /// Prazo em segundos (0 para o prazo padrão)
+    uint64_t seed;     /// Semente do gerador de números aleatórios
+    instance_t instance;
+};
+
+/*! Resposta a uma requisição. */
+struct response {
+    uint64_t id;
+    response_kind kind;
+    double time;         /// Tempo desde o início da solução (em segundos)
+    uint32_t iteration;  /// Iteração do BRKGA, ou posição na fila
+    cost_type cost;      /// Custo da melhor solução (-1 se não houver)
+    solution_t solution; /// Solução (para `solution`)
+    std::string message; /// Mensagem de erro (para `error`)
+};
+
+namespace detail {
+
+inline constexpr char REQUEST_MAGIC[4] = {'S', 'P', 'R', 'Q'};
+inline constexpr char RESPONSE_MAGIC[4] = {'S', 'P', 'R', 'S'};
+
+/*! Escritor de mensagens binárias. */
+class writer {
+  private:
+    std::vector<char> m_data;
+
+  public:
+    void put(const void* data, size_t size) {
+        const char* p = static_cast<const char*>(data);
+        m_data.insert(m_data.end(), p, p + size);
+    }
+
+    template <typename T> void put(const T& value) {
+        put(&value, sizeof(T));
+    }
+
+    std::vector<char>& data() { return m_data; }
+};
+
+/*! Leitor de mensagens binárias. */
+class reader {
+  private:
+    const std::vector<char>& m_data;
+    size_t m_pos;
+
+  public:
+    reader(const std::vector<char>& data) : m_data(data), m_pos(0) {}
+
+    void get(void* data, size_t size) {
+        if (m_data.size() - m_pos < size) {
+            throw std::runtime_error("truncated message");
+        }
+        std::memcpy(data, m_data.data() + m_pos, size);
+        m_pos += size;
+    }
+
+    template <typename T> T get() {
+        T value;
+        get(&value, sizeof(T));
+        return value;
+    }
+
+    size_t remaining() const { return m_data.size() - m_pos; }
+
+    /**
+     * Lê um número de elementos a seguir, verificando que a mensagem tem
+     * espaço para eles (com pelo menos `size` bytes cada).
+     */
+    size_t count(size_t size, bool wide = false) {
+        uint64_t n = wide ? get<uint64_t>() : get<uint32_t>();
+        if (n > remaining() / size) {
+            throw std::runtime_error("truncated message");
+        }
+        return n;
+    }
+
+    void expect(const char (&magic)[4]) {
+        char read[4];
+        get(read, sizeof(read));
+        if (std::memcmp(read, magic, sizeof(read)) != 0) {
+            throw std::runtime_error("invalid message");
+        }
+    }
+};
+
+} // namespace detail
+
+inline std::vector<char> encode(const request& req) {
+    detail::writer out;
+    out.put(detail::REQUEST_MAGIC, 4);
+    out.put<uint64_t>(req.id);
+    out.put<double>(req.time_limit);
+    out.put<uint64_t>(req.seed);
+    out.put<double>(req.instance.recipient_length);
+    out.put<uint64_t>(req.instance.rects.size());
+    for (const auto& rect : req.instance.rects) {
+        out.put<double>(rect.length);
+        out.put<double>(rect.height);
+        out.put<double>(rect.weight);
+    }
+    return std::move(out.data());
+}
+
+inline request decode_request(const std::vector<char>& payload) {
+    detail::reader in(payload);
+    in.expect(detail::REQUEST_MAGIC);
+
+    request req;
+    req.id = in.get<uint64_t>();
+    req.time_limit = in.get<double>();
+    req.seed = in.get<uint64_t>();
+    req.instance.recipient_length = in.get<double>();
+    req.instance.rects.resize(in.count(3 * sizeof(double), true));
+    for (auto& rect : req.instance.rects) {
+        rect.length = in.get<double>();
+        rect.height = in.get<double>();
+        rect.weight = in.get<double>();
+    }
+    return req;
+}
+
+inline std::vector<char> encode(const response& res) {
+    detail::writer out;
+    out.put(detail::RESPONSE_MAGIC, 4);
+    out.put<uint64_t>(res.id);
+    out.put<uint8_t>(uint8_t(res.kind));
+    out.put<double>(res.time);
+    out.put<uint32_t>(res.iteration);
+    out.put<double>(res.cost);
+    if (res.kind == response_kind::solution) {
+        out.put<uint32_t>(res.solution.size());
+        for (const auto& level : res.solution) {
+            out.put<uint32_t>(level.size());
+            for (size_t index : level) {
+                out.put<uint32_t>(index);
+            }
+        }
+    } else if (res.kind == response_kind::error) {
+        out.put(res.message.data(), res.message.size());
+    }
+    return std::move(out.data());
+}
+
+inline response decode_response(const std::vector<char>& payload) {
+    detail::reader in(payload);
+    in.expect(detail::RESPONSE_MAGIC);
+
+    response res;
+    res.id = in.get<uint64_t>();
+    res.kind = response_kind(in.get<uint8_t>());
+    res.time = in.get<double>();
+    res.iteration = in.get<uint32_t>();
+    res.cost = in.get<double>();
+    if (res.kind == response_kind::solution) {
+        res.solution.resize(in.count(sizeof(uint32_t)));
+        for (auto& level : res.solution) {
+            level.resize(in.count(sizeof(uint32_t)));
+            for (auto& index : level) {
+                index = in.get<uint32_t>();
+            }
+        }
+    } else if (res.kind == response_kind::error) {
+        res.message.resize(in.remaining());
+        in.get(res.message.data(), res.message.size());
+    }
+    return res;
+}
+
+} // namespace strip_packing::service
+
+#endif // STRIP_PACKING_SERVICE_HPP
@@ -0,0 +1,122 @@
+#ifndef STRIP_PACKING_TRACE_HPP
+#define STRIP_PACKING_TRACE_HPP
+
+#include "util/spsc_ring.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace strip_packing::trace {
+
+/*! Tipo de evento de convergência. */
+enum class event_kind : uint8_t {
+    improvement, /// Nova melhor solução
+    generation,  /// Fim de uma geração
+    shake,       /// Perturbação das populações
+};
+
+/*! Evento de convergência. */
+struct event {
+    event_kind kind;
+    double time;             /// Tempo desde o início (em segundos)
+    uint32_t iteration;      /// Iteração do algoritmo
+    double best;             /// Melhor fitness global
+    double population_best;  /// Melhor fitness dentre as populações
+    double population_mean;  /// Fitness médio das populações
+    double elite_threshold;  /// Pior fitness de elite (ou intensidade)
+};
+
+/**
+ * Registro assíncrono da convergência do algoritmo.
+ *
+ * Os eventos são inseridos em uma fila circular sem travas, e uma thread
+ * separada os escreve em um arquivo CSV. As threads do algoritmo nunca
+ * bloqueiam esperando E/S: caso a fila esteja cheia, o evento é descartado e
+ * contabilizado.
+ *
+ * O registro deve ser alimentado por uma única thread (a thread principal do
+ * algoritmo, onde rodam os observadores e critérios de parada).
+ */
+class convergence_trace {
+  private:
+    util::spsc_ring<event> m_ring;
+    std::ofstream m_out;
+
+    std::atomic<bool> m_stop;
+    std::atomic<uint64_t> m_dropped;
+    std::thread m_writer;
+
+    static const char* name(event_kind kind) {
+        switch (kind) {
+        case event_kind::improvement:
+            return "improvement";
+        case event_kind::generation:
+            return "generation";
+        case event_kind::shake:
+            return "shake";
+        }
+        return "unknown";
+    }
+
+    /*! Escreve os eventos pendentes. Devolve se algum evento foi escrito. */
+    bool drain() {
+        event e;
+        bool any = false;
+        while (m_ring.try_pop(e)) {
+            m_out << name(e.kind) << ',' << e.time << ',' << e.iteration << ','
+                  << e.best << ',' << e.population_best << ','
+                  << e.population_mean << ',' << e.elite_threshold << '\n';
+            any = true;
+        }
+        return any;
+    }
+
+    void write_loop() {
+        while (!m_stop.load(std::memory_order_acquire)) {
+            if (!drain()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        drain();
+        m_out.flush();
+    }
+
+  public:
+    convergence_trace(const std::string& filename, size_t capacity = 1 << 16)
+        : m_ring(capacity), m_out(filename), m_stop(false), m_dropped(0) {
+        if (!m_out) {
+            throw std::runtime_error("cannot open trace file " + filename);
+        }
+        m_out.precision(10);
+        m_out << "event,time,iteration,best,population_best,population_mean,"
+                 "elite_threshold\n";
+        m_writer = std::thread([this] { write_loop(); });
+    }
+
+    convergence_trace(const convergence_trace&) = delete;
+    convergence_trace& operator=(const convergence_trace&) = delete;
+
+    ~convergence_trace() {
+        m_stop.store(true, std::memory_order_release);
+        m_writer.join();
+    }
+
+    /*! Registra um evento, sem bloquear. */
+    void record(const event& e) {
+        if (!m_ring.try_push(e)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /*! Número de eventos descartados por falta de espaço na fila. */
+    uint64_t dropped() const { return m_dropped; }
+};
+
+} // namespace strip_packing::trace
+
+#endif // STRIP_PACKING_TRACE_HPP
@@ -0,0 +1,325 @@
+#ifndef STRIP_PACKING_TUNING_HPP
+#define STRIP_PACKING_TUNING_HPP
+
+#include "defs.hpp"
+#include "pipeline.hpp"
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace strip_packing::tuning {
+
+/**
+ * Ajuste automático de parâmetros por corridas (F-race).
+ *
+ * Configurações candidatas são avaliadas sobre uma sequência de blocos (uma
+ * instância de treino com uma semente, igual para todas as candidatas), e,
+ * a partir de alguns blocos, o teste de Friedman sobre os postos das
+ * candidatas em cada bloco decide se há diferença entre elas. Se houver, as
+ * candidatas cuja soma de postos é pior que a da melhor por mais que a
+ * diferença crítica do teste post-hoc são descartadas.
+ *
+ * As configurações ajustadas são agrupadas por classe de instância (veja
+ * `instance_class`), e escritas no formato de configuração do BRKGA, com os
+ * parâmetros das heurísticas construtivas em comentários (veja `save`).
+ */
+
+/**
+ * Classe de uma instância, usada para escolher a configuração ajustada. É
+ * formada pelo tamanho arredondado para uma potência de 2, pelo número
+ * médio de retângulos que cabem em um nível ("wide" para menos de 2,
+ * "medium" para menos de 8 e "narrow" caso contrário), e pela variação das
+ * alturas ("flat" para coeficiente de variação abaixo de 0.1, e "varied"
+ * caso contrário). Por exemplo, "n1024-medium-varied". O(n).
+ */
+inline std::string instance_class(const instance_t& instance) {
+    size_t n = std::max<size_t>(1, instance.rects.size());
+    size_t size = size_t(1) << size_t(std::round(std::log2(n)));
+
+    double mean_length = 0, mean_height = 0;
+    for (const auto& rect : instance.rects) {
+        mean_length += rect.length / n;
+        mean_height += rect.height / n;
+    }
+    double height =
+        pipeline::stddev(instance, [](const rect_t& r) { return r.height; });
+
+    double per_level = mean_length > 0
+                           ? instance.recipient_length / mean_length
+                           : std::numeric_limits<double>::infinity();
+    const char* width = per_level < 2   ? "wide"
+                        : per_level < 8 ? "medium"
+                                        : "narrow";
+    const char* shape =
+        mean_height > 0 && height / mean_height >= 0.1 ? "varied" : "flat";
+
+    std::ostringstream key;
+    key << 'n' << size << '-' << width << '-' << shape;
+    return key.str();
+}
+
+/*! Configuração completa de uma execução. */
+struct configuration {
+    pipeline::options options;    /// Heurísticas construtivas
+    BRKGA::BrkgaParams brkga;     /// Parâmetros do BRKGA
+    BRKGA::ControlParams control; /// Parâmetros de controle do BRKGA
+};
+
+/**
+ * Sorteia uma configuração candidata em torno de uma configuração base:
+ * tamanhos, intervalos e números de amostras são multiplicados por uma
+ * potência de 2 entre 1/4 e 2, e as proporções e desvios são sorteados
+ * uniformemente em faixas fixas.
+ */
+template <typename URBG>
+configuration sample(const configuration& base, URBG&& rng) {
+    std::uniform_int_distribution<int> exponent(-2, 1);
+    auto scale = [&](auto value) {
+        int e = exponent(rng);
+        auto scaled = e >= 0 ? value << e : value >> -e;
+        return value > 0 ? std::max<decltype(value)>(1, scaled) : value;
+    };
+    auto uniform = [&](double a, double b) {
+        return std::uniform_real_distribution<>(a, b)(rng);
+    };
+
+    configuration c = base;
+    c.options.first_fit_samples = scale(base.options.first_fit_samples);
+    c.options.best_fit_samples = scale(base.options.best_fit_samples);
+    c.options.first_fit_deviations = uniform(0.05, 1.0);
+    c.options.best_fit_deviations = uniform(0.05, 1.0);
+
+    c.brkga.elite_percentage = uniform(0.1, 0.3);
+    c.brkga.mutants_percentage = uniform(0.05, 0.3);
+    c.brkga.shaking_intensity_lower_bound = uniform(0.05, 0.3);
+    c.brkga.shaking_intensity_upper_bound = std::min(
+        1.0, c.brkga.shaking_intensity_lower_bound + uniform(0.1, 0.5));
+
+    // A elite precisa comportar os pais de elite, e a população, todos os
+    // pais.
+    c.brkga.population_size = std::max(
+        {scale(base.brkga.population_size), c.brkga.total_parents,
+         unsigned(std::ceil(c.brkga.num_elite_parents /
+                            c.brkga.elite_percentage))});
+
+    c.control.ipr_interval = scale(base.control.ipr_interval);
+    c.control.shake_interval = scale(base.control.shake_interval);
+    return c;
+}
+
+/*! Prefixo das linhas com parâmetros das heurísticas construtivas. */
+inline const std::string RUNNER_PREFIX = "# runner: ";
+
+/**
+ * Escreve uma configuração. Os parâmetros das heurísticas construtivas são
+ * escritos como comentários, para que o arquivo continue sendo uma
+ * configuração válida do BRKGA (veja `read_runner_options`).
+ */
+inline void save(const std::string& filename, const configuration& c) {
+    BRKGA::writeConfiguration(filename, c.brkga, c.control);
+
+    std::ofstream out(filename, std::ios::app);
+    out << "\n# Parameters of the constructive heuristics, read by "
+           "mc859-strip-packing-heuristics.\n";
+    out << RUNNER_PREFIX << "first_fit_samples "
+        << c.options.first_fit_samples << '\n';
+    out << RUNNER_PREFIX << "first_fit_deviations "
+        << c.options.first_fit_deviations << '\n';
+    out << RUNNER_PREFIX << "best_fit_samples " << c.options.best_fit_samples
+        << '\n';
+    out << RUNNER_PREFIX << "best_fit_deviations "
+        << c.options.best_fit_deviations << '\n';
+}
+
+/*! Lê os parâmetros das heurísticas construtivas de uma configuração. */
+inline std::map<std::string, std::string>
+read_runner_options(const std::string& filename) {
+    std::map<std::string, std::string> options;
+    std::ifstream in(filename);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, RUNNER_PREFIX.size(), RUNNER_PREFIX) != 0) {
+            continue;
+        }
+        std::istringstream fields(line.substr(RUNNER_PREFIX.size()));
+        std::string key, value;
+        if (fields >> key >> value) {
+            options[key] = value;
+        }
+    }
+    return options;
+}
+
+namespace detail {
+
+/*! Quantil da normal padrão (Abramowitz e Stegun 26.2.23). */
+inline double normal_quantile(double p) {
+    double q = p < 0.5 ? p : 1 - p;
+    double t = std::sqrt(-2 * std::log(q));
+    double z = t - (2.515517 + 0.802853 * t + 0.010328 * t * t) /
+                       (1 + 1.432788 * t + 0.189269 * t * t +
+                        0.001308 * t * t * t);
+    return p < 0.5 ? -z : z;
+}
+
+/*! Quantil da qui-quadrado (aproximação de Wilson e Hilferty). */
+inline double chi2_quantile(double p, double df) {
+    double z = normal_quantile(p);
+    double a = 2 / (9 * df);
+    return df * std::pow(1 - a + z * std::sqrt(a), 3);
+}
+
+/*! Quantil da t de Student (expansão de Cornish e Fisher). */
+inline double t_quantile(double p, double df) {
+    double z = normal_quantile(p);
+    double z3 = z * z * z, z5 = z3 * z * z;
+    return z + (z3 + z) / (4 * df) +
+           (5 * z5 + 16 * z3 + 3 * z) / (96 * df * df);
+}
+
+} // namespace detail
+
+/**
+ * Corrida entre configurações candidatas (F-race).
+ *
+ * Os resultados de cada bloco são adicionados com `add_block`, na ordem de
+ * `alive()`. A partir de `first_test` blocos, cada bloco é seguido do teste
+ * de Friedman com nível de significância `alpha` e, caso ele rejeite a
+ * igualdade, do descarte das candidatas dominadas.
+ */
+class race {
+  private:
+    size_t m_candidates;
+    double m_alpha;
+    size_t m_first_test;
+
+    std::vector<size_t> m_alive;             /// Candidatas restantes
+    std::vector<std::vector<double>> m_cost; /// Custo por bloco e candidata
+
+    /*! Postos (médios, em caso de empate) das restantes em um bloco. */
+    std::vector<double> ranks(const std::vector<double>& block) const {
+        size_t k = m_alive.size();
+        std::vector<size_t> order(k);
+        for (size_t i = 0; i < k; i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return block[m_alive[a]] < block[m_alive[b]];
+        });
+        std::vector<double> rank(k);
+        for (size_t i = 0; i < k;) {
+            size_t j = i;
+            while (j + 1 < k && block[m_alive[order[j + 1]]] ==
+                                    block[m_alive[order[i]]]) {
+                j++;
+            }
+            for (size_t l = i; l <= j; l++) {
+                rank[order[l]] = (i + j) / 2.0 + 1;
+            }
+            i = j + 1;
+        }
+        return rank;
+    }
+
+    /*! Teste de Friedman e descarte das dominadas. O(b k lg k). */
+    void test() {
+        size_t k = m_alive.size();
+        double b = m_cost.size();
+        std::vector<double> sum(k, 0);
+        double squares = 0;
+        for (const auto& block : m_cost) {
+            auto rank = ranks(block);
+            for (size_t j = 0; j < k; j++) {
+                sum[j] += rank[j];
+                squares += rank[j] * rank[j];
+            }
+        }
+
+        // Sem variação nos postos (todos empatados), não há o que testar.
+        double correction = b * k * (k + 1) * (k + 1) / 4;
+        if (squares - correction <= 0) {
+            return;
+        }
+        double spread = 0, sum_squares = 0;
+        for (size_t j = 0; j < k; j++) {
+            spread += std::pow(sum[j] - b * (k + 1) / 2, 2);
+            sum_squares += sum[j] * sum[j];
+        }
+        double statistic = (k - 1) * spread / (squares - correction);
+        if (statistic <= detail::chi2_quantile(1 - m_alpha, k - 1)) {
+            return;
+        }
+
+        double df = (b - 1) * (k - 1);
+        double difference =
+            detail::t_quantile(1 - m_alpha / 2, df) *
+            std::sqrt(2 * b * (squares - sum_squares / b) / df);
+        double best = *std::min_element(sum.begin(), sum.end());
+
+        std::vector<size_t> alive;
+        for (size_t j = 0; j < k; j++) {
+            if (sum[j] - best <= difference) {
+                alive.push_back(m_alive[j]);
+            }
+        }
+        m_alive = std::move(alive);
+    }
+
+  public:
+    race(size_t candidates, double alpha = 0.05, size_t first_test = 5)
+        : m_candidates(candidates), m_alpha(alpha),
+          m_first_test(std::max<size_t>(2, first_test)) {
+        for (size_t i = 0; i < candidates; i++) {
+            m_alive.push_back(i);
+        }
+    }
+
+    /*! Índices das candidatas restantes. */
+    const std::vector<size_t>& alive() const { return m_alive; }
+
+    /*! Número de blocos avaliados. */
+    size_t blocks() const { return m_cost.size(); }
+
+    /**
+     * Adiciona os custos das candidatas restantes em um bloco (na ordem de
+     * `alive()`) e descarta as dominadas.
+     */
+    void add_block(const std::vector<double>& costs) {
+        std::vector<double> block(m_candidates,
+                                  std::numeric_limits<double>::quiet_NaN());
+        for (size_t j = 0; j < m_alive.size(); j++) {
+            block[m_alive[j]] = costs[j];
+        }
+        m_cost.push_back(std::move(block));
+        if (m_cost.size() >= m_first_test && m_alive.size() > 1) {
+            test();
+        }
+    }
+
+    /*! Melhor candidata restante: a de menor soma de postos. */
+    size_t best() const {
+        std::vector<double> sum(m_alive.size(), 0);
+        for (const auto& block : m_cost) {
+            auto rank = ranks(block);
+            for (size_t j = 0; j < sum.size(); j++) {
+                sum[j] += rank[j];
+            }
+        }
+        return m_alive[std::min_element(sum.begin(), sum.end()) -
+                       sum.begin()];
+    }
+};
+
+} // namespace strip_packing::tuning
+
+#endif // STRIP_PACKING_TUNING_HPP
@@ -0,0 +1,73 @@
+#ifndef STRIP_PACKING_UTIL_DEADLINE_HPP
+#define STRIP_PACKING_UTIL_DEADLINE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+namespace strip_packing::util {
+
+/**
+ * Prazo de execução (orçamento de tempo de relógio).
+ *
+ * Um prazo expira quando o tempo dado se esgota ou quando uma flag de
+ * cancelamento externa (por exemplo, ativada por um tratador de sinais) é
+ * ativada. Um prazo com tempo total nulo nunca expira por tempo.
+ */
+class deadline {
+  public:
+    using clock = std::chrono::steady_clock;
+
+  private:
+    clock::time_point m_start;         /// Início da contagem
+    double m_total;                    /// Tempo total (em segundos)
+    const std::atomic<bool>* m_cancel; /// Flag de cancelamento (opcional)
+
+  public:
+    /*! Cria um prazo que expira após um número de segundos. */
+    deadline(double seconds = 0, const std::atomic<bool>* cancel = nullptr)
+        : m_start(clock::now()), m_total(seconds), m_cancel(cancel) {}
+
+    /*! Se o prazo tem limite de tempo. */
+    bool bounded() const { return m_total > 0; }
+
+    /*! Tempo decorrido desde o início (em segundos). */
+    double elapsed() const {
+        return std::chrono::duration<double>(clock::now() - m_start).count();
+    }
+
+    /*! Tempo restante (em segundos), ou infinito caso não haja limite. */
+    double remaining() const {
+        if (!bounded()) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return std::max(0.0, m_total - elapsed());
+    }
+
+    /*! Se a execução foi cancelada externamente. */
+    bool cancelled() const {
+        return m_cancel && m_cancel->load(std::memory_order_relaxed);
+    }
+
+    /*! Se o prazo expirou, por tempo ou por cancelamento. */
+    bool expired() const {
+        return cancelled() || (bounded() && elapsed() >= m_total);
+    }
+
+    /**
+     * Cria um prazo para uma fração do tempo restante, que também expira
+     * junto com este prazo.
+     */
+    deadline slice(double fraction) const {
+        deadline sub(*this);
+        if (bounded()) {
+            sub.m_total = elapsed() + remaining() * fraction;
+        }
+        return sub;
+    }
+};
+
+} // namespace strip_packing::util
+
+#endif // STRIP_PACKING_UTIL_DEADLINE_HPP
@@ -0,0 +1,84 @@
+#ifndef STRIP_PACKING_UTIL_FENWICK_TREE_HPP
+#define STRIP_PACKING_UTIL_FENWICK_TREE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace strip_packing::util {
+
+/**
+ * Árvore de Fenwick (Binary Indexed Tree) para somas de prefixo.
+ *
+ * Cada posição i (começando em 1) do vetor interno guarda a soma dos
+ * elementos no intervalo (i - lsb(i), i], onde lsb(i) é o bit menos
+ * significativo de i. Isso permite atualizar um elemento e consultar somas de
+ * prefixo em O(log n), além de adicionar elementos ao fim do conjunto.
+ *
+ * @param T - tipo de valor dos elementos da árvore.
+ * @param Allocator - alocador de memória.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class fenwick_tree {
+  private:
+    std::vector<T, Allocator> m_tree; /// Somas parciais (índice i guarda i+1)
+
+    /*! Bit menos significativo de um índice. O(1). */
+    static constexpr inline size_t lsb(size_t i) { return i & (~i + 1); }
+
+  public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+
+    /*! Constrói uma árvore vazia. */
+    fenwick_tree(const Allocator& alloc = Allocator()) : m_tree(alloc) {}
+
+    /*! Constrói uma árvore com tamanho fixo e valores nulos. */
+    fenwick_tree(size_type size, const Allocator& alloc = Allocator())
+        : m_tree(size, T(0), alloc) {}
+
+    /*! Tamanho (número de elementos) da árvore. */
+    size_type size() const { return m_tree.size(); }
+
+    bool empty() const { return m_tree.empty(); }
+
+    void reserve(size_type new_cap) { m_tree.reserve(new_cap); }
+
+    /**
+     * Soma dos elementos nas posições [0, index). O(log n).
+     */
+    T prefix_sum(size_type index) const {
+        T total = T(0);
+        for (size_t i = index; i > 0; i -= lsb(i)) {
+            total += m_tree[i - 1];
+        }
+        return total;
+    }
+
+    /*! Soma de todos os elementos. O(log n). */
+    T sum() const { return prefix_sum(size()); }
+
+    /*! Soma dos elementos nas posições [index, n). O(log n). */
+    T suffix_sum(size_type index) const { return sum() - prefix_sum(index); }
+
+    /*! Soma um valor ao elemento em uma posição. O(log n). */
+    void add(size_type index, T delta) {
+        for (size_t i = index + 1; i <= size(); i += lsb(i)) {
+            m_tree[i - 1] += delta;
+        }
+    }
+
+    /*! Adiciona um valor ao fim do conjunto. O(log n) amortizado. */
+    void push_back(T value) {
+        // O novo nó cobre o intervalo (i - lsb(i), i], então sua soma parcial
+        // é o próprio valor somado aos elementos anteriores nesse intervalo.
+        size_t i = size() + 1;
+        T partial = value + prefix_sum(i - 1) - prefix_sum(i - lsb(i));
+        m_tree.push_back(partial);
+    }
+};
+
+} // namespace strip_packing::util
+
+#endif // STRIP_PACKING_UTIL_FENWICK_TREE_HPP
@@ -193,10 +193,13 @@ class first_fit_tree {
             m_summary.resize(1);
             m_data.resize(1);
         } else if (new_cap > m_data.size()) {
+            // A antiga raiz passa a ser a subárvore esquerda da nova, então o
+            // máximo dela é propagado para os novos ancestrais.
             T value = m_summary[root()];
-            node_t node = root(), next = node;
+            node_t node = root();
             resize_vectors(new_cap);
-            for (node = next; node < m_summary.size(); node = parent(node)) {
+            for (node = parent(node); node < m_summary.size();
+                 node = parent(node)) {
                 if (m_compare(m_summary[node], value)) {
                     m_summary[node] = value;
                 } else {
@@ -232,6 +235,45 @@ class first_fit_tree {
         return node;
     }
 
+    /**
+     * Encaixa `count` itens de mesmo tamanho `value`, um a um, na primeira
+     * posição com valor maior ou igual ao tamanho, diminuindo o valor da
+     * posição escolhida.
+     *
+     * Como itens iguais que cabem em uma posição ocupam essa posição até que
+     * ela não comporte mais nenhum, todos os itens de uma posição são
+     * encaixados de uma vez. Para cada posição usada, chama `place(index, k)`
+     * com o número k de itens encaixados nela, em ordem crescente de índice.
+     *
+     * Devolve o número de itens que não couberam em nenhuma posição.
+     * O((m + 1) log n), onde m é o número de posições usadas.
+     */
+    template <typename F>
+    size_t first_fit_n(value_type value, size_t count, F&& place) {
+        while (count > 0) {
+            size_t index = first_fit(value);
+            if (index == npos) {
+                break;
+            }
+
+            size_t k = count;
+            if (value > T(0)) {
+                T free = m_data[index];
+                k = std::min<size_t>(count, size_t(free / value));
+                // Corrige erros de arredondamento da divisão.
+                while (k > 1 && free - T(k) * value < T(0)) {
+                    k--;
+                }
+                k = std::max<size_t>(k, 1);
+            }
+
+            decrease(index, T(k) * value);
+            place(index, k);
+            count -= k;
+        }
+        return count;
+    }
+
     /*! Diminui o valor de uma posição no conjunto. O(log n). */
     void decrease(size_type index, T delta) {
         node_t node = index;
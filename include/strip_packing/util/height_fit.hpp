@@ -0,0 +1,255 @@
+#ifndef STRIP_PACKING_UTIL_HEIGHT_FIT_HPP
+#define STRIP_PACKING_UTIL_HEIGHT_FIT_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace strip_packing::util {
+
+/**
+ * Índice de encaixe por espaço livre e altura dos níveis.
+ *
+ * Enquanto a `first_fit_tree` encontra o primeiro nível com espaço livre
+ * suficiente para um retângulo, este índice encontra o primeiro nível com
+ * espaço suficiente e altura maior ou igual à do retângulo, isto é, um nível
+ * que o retângulo não torna mais alto. Caso não exista nenhum, encontra o
+ * nível com espaço suficiente cuja altura aumentaria menos.
+ *
+ * As alturas possíveis são conhecidas de antemão (as alturas dos retângulos
+ * da instância), e o índice é uma árvore de segmentos sobre a ordem das
+ * alturas. Cada nó dessa árvore guarda uma árvore de segmentos esparsa sobre
+ * os índices dos níveis com altura no seu intervalo, com o máximo espaço
+ * livre de cada subárvore. Assim, as consultas e atualizações custam
+ * O(log H log L), onde H é o número de alturas distintas e L o número de
+ * níveis, e a memória usada é O(L log H log L).
+ *
+ * @param T - tipo do espaço livre e da altura dos níveis.
+ */
+template <typename T> class height_fit_index {
+  private:
+    /*! Nó de uma árvore esparsa sobre os índices dos níveis. */
+    struct node_t {
+        T max;          /// Máximo espaço livre da subárvore
+        uint32_t left;  /// Filho esquerdo (0 se vazio)
+        uint32_t right; /// Filho direito (0 se vazio)
+    };
+
+    static constexpr T NONE = std::numeric_limits<T>::lowest();
+
+    std::vector<T> m_heights; /// Alturas possíveis, em ordem crescente
+    size_t m_leaves;          /// Folhas da árvore de alturas
+    size_t m_span;            /// Intervalo de índices das árvores esparsas
+
+    std::vector<node_t> m_nodes;   /// Nós das árvores esparsas (0 é o nulo)
+    std::vector<uint32_t> m_roots; /// Raíz da árvore esparsa de cada nó
+
+    std::vector<T> m_free;      /// Espaço livre de cada nível
+    std::vector<size_t> m_rank; /// Posição da altura de cada nível
+
+    /*! Posição de uma altura na ordem das alturas. O(log H). */
+    size_t rank(T height) const {
+        return std::lower_bound(m_heights.begin(), m_heights.end(), height) -
+               m_heights.begin();
+    }
+
+    /**
+     * Atribui o valor de um índice em uma árvore esparsa, criando os nós
+     * necessários. Devolve a raíz da árvore. O(log L).
+     */
+    uint32_t assign(uint32_t root, size_t index, T value) {
+        uint32_t path[64];
+        size_t depth = 0;
+
+        if (root == 0) {
+            root = m_nodes.size();
+            m_nodes.push_back({NONE, 0, 0});
+        }
+
+        uint32_t node = root;
+        size_t lo = 0, hi = m_span;
+        while (hi - lo > 1) {
+            path[depth++] = node;
+            size_t mid = (lo + hi) / 2;
+            bool left = index < mid;
+            uint32_t child = left ? m_nodes[node].left : m_nodes[node].right;
+            if (child == 0) {
+                child = m_nodes.size();
+                m_nodes.push_back({NONE, 0, 0});
+                (left ? m_nodes[node].left : m_nodes[node].right) = child;
+            }
+            node = child;
+            (left ? hi : lo) = mid;
+        }
+        m_nodes[node].max = value;
+
+        while (depth > 0) {
+            node_t& n = m_nodes[path[--depth]];
+            n.max = std::max(m_nodes[n.left].max, m_nodes[n.right].max);
+        }
+        return root;
+    }
+
+    /*! Primeiro índice de uma árvore esparsa com valor ≥ `value`. O(log L). */
+    size_t first_fit(uint32_t node, T value) const {
+        if (m_nodes[node].max < value) {
+            return npos;
+        }
+
+        size_t lo = 0, hi = m_span;
+        while (hi - lo > 1) {
+            size_t mid = (lo + hi) / 2;
+            if (!(m_nodes[m_nodes[node].left].max < value)) {
+                node = m_nodes[node].left;
+                hi = mid;
+            } else {
+                node = m_nodes[node].right;
+                lo = mid;
+            }
+        }
+        return lo;
+    }
+
+    /*! Atribui o espaço livre de um nível nas árvores. O(log H log L). */
+    void update(size_t level, size_t rank, T value) {
+        for (size_t node = m_leaves + rank; node > 0; node /= 2) {
+            m_roots[node] = assign(m_roots[node], level, value);
+        }
+    }
+
+    /**
+     * Maior posição de altura menor que `limit` com algum nível com espaço
+     * livre ≥ `value`, dentre as posições [lo, hi) de um nó. O(log H).
+     */
+    size_t highest_rank(size_t node, size_t lo, size_t hi, size_t limit,
+                        T value) const {
+        if (lo >= limit || m_nodes[m_roots[node]].max < value) {
+            return npos;
+        }
+        if (hi - lo == 1) {
+            return lo;
+        }
+
+        size_t mid = (lo + hi) / 2;
+        size_t found = highest_rank(2 * node + 1, mid, hi, limit, value);
+        if (found == npos) {
+            found = highest_rank(2 * node, lo, mid, limit, value);
+        }
+        return found;
+    }
+
+  public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    /**
+     * Constrói um índice vazio, dadas as alturas possíveis dos níveis (em
+     * qualquer ordem, com repetições) e o número máximo de níveis.
+     * O(H log H).
+     */
+    template <typename InputIterator>
+    height_fit_index(InputIterator first, InputIterator last,
+                     size_t max_levels)
+        : m_heights(first, last), m_leaves(1), m_span(1) {
+        std::sort(m_heights.begin(), m_heights.end());
+        m_heights.erase(std::unique(m_heights.begin(), m_heights.end()),
+                        m_heights.end());
+        while (m_leaves < m_heights.size()) {
+            m_leaves *= 2;
+        }
+        while (m_span < max_levels) {
+            m_span *= 2;
+        }
+
+        m_nodes.push_back({NONE, 0, 0});
+        m_roots.assign(2 * m_leaves, 0);
+        m_free.reserve(max_levels);
+        m_rank.reserve(max_levels);
+    }
+
+    /*! Número de níveis. */
+    size_t size() const { return m_free.size(); }
+
+    /*! Espaço livre de um nível. O(1). */
+    T free(size_t level) const { return m_free[level]; }
+
+    /*! Altura de um nível. O(1). */
+    T height(size_t level) const { return m_heights[m_rank[level]]; }
+
+    /*! Adiciona um nível no topo. O(log H log L). */
+    size_t push_level(T free, T height) {
+        assert(m_free.size() < m_span);
+        size_t level = m_free.size();
+        m_free.push_back(free);
+        m_rank.push_back(rank(height));
+        assert(m_rank.back() < m_heights.size());
+        update(level, m_rank.back(), free);
+        return level;
+    }
+
+    /*! Diminui o espaço livre de um nível. O(log H log L). */
+    void decrease(size_t level, T delta) {
+        m_free[level] -= delta;
+        update(level, m_rank[level], m_free[level]);
+    }
+
+    /*! Altera a altura de um nível. O(log H log L). */
+    void set_height(size_t level, T height) {
+        size_t r = rank(height);
+        assert(r < m_heights.size());
+        if (r != m_rank[level]) {
+            update(level, m_rank[level], NONE);
+            m_rank[level] = r;
+            update(level, r, m_free[level]);
+        }
+    }
+
+    /**
+     * Primeiro nível com espaço livre ≥ `length` e altura ≥ `height`.
+     * O(log H log L).
+     */
+    size_t fit(T length, T height) const {
+        size_t found = npos;
+        size_t lo = m_leaves + rank(height), hi = 2 * m_leaves;
+        for (; lo < hi; lo /= 2, hi /= 2) {
+            if (lo & 1) {
+                found = std::min(found, first_fit(m_roots[lo++], length));
+            }
+            if (hi & 1) {
+                found = std::min(found, first_fit(m_roots[--hi], length));
+            }
+        }
+        return found;
+    }
+
+    /**
+     * Primeiro nível dentre os mais altos com espaço livre ≥ `length` e
+     * altura < `height`, isto é, o nível que menos aumenta de altura.
+     * O(log H + log L).
+     */
+    size_t closest_fit(T length, T height) const {
+        size_t r = highest_rank(1, 0, m_leaves, rank(height), length);
+        if (r == npos) {
+            return npos;
+        }
+        return first_fit(m_roots[m_leaves + r], length);
+    }
+
+    /**
+     * Nível para um retângulo: o primeiro que ele não torna mais alto, ou o
+     * que menos aumenta de altura. O(log H log L).
+     */
+    size_t find(T length, T height) const {
+        size_t level = fit(length, height);
+        if (level == npos) {
+            level = closest_fit(length, height);
+        }
+        return level;
+    }
+};
+
+} // namespace strip_packing::util
+
+#endif // STRIP_PACKING_UTIL_HEIGHT_FIT_HPP
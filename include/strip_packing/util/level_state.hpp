@@ -0,0 +1,168 @@
+#ifndef STRIP_PACKING_UTIL_LEVEL_STATE_HPP
+#define STRIP_PACKING_UTIL_LEVEL_STATE_HPP
+
+#include "../defs.hpp"
+#include "fenwick_tree.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace strip_packing::util {
+
+/**
+ * Estado dinâmico dos níveis de uma solução.
+ *
+ * Mantém, para cada nível, o multiconjunto das alturas dos retângulos nele
+ * (para obter a altura máxima após remoções) e a soma dos pesos, junto de
+ * árvores de Fenwick sobre as alturas e os pesos dos níveis.
+ *
+ * O custo de uma solução pode ser escrito como
+ *
+ *     custo = sum_i W_i * B_i = sum_j H_j * (sum_{i > j} W_i),
+ *
+ * onde W_i é o peso total do nível i, H_j é a altura do nível j e B_i é a
+ * altura da base do nível i (soma das alturas dos níveis abaixo dele). Assim,
+ * mudar o peso de um nível altera o custo proporcionalmente à soma de prefixo
+ * das alturas, e mudar a altura de um nível altera o custo proporcionalmente à
+ * soma de sufixo dos pesos, ambos computáveis em O(log L).
+ */
+class level_state {
+  private:
+    const instance_t& m_instance;
+
+    std::vector<std::map<dim_type, size_t>> m_heights; /// Alturas por nível
+    std::vector<dim_type> m_level_height;              /// Altura dos níveis
+    std::vector<cost_type> m_level_weight;             /// Peso dos níveis
+
+    fenwick_tree<dim_type> m_height_tree;  /// Somas de prefixo de alturas
+    fenwick_tree<cost_type> m_weight_tree; /// Somas de sufixo de pesos
+
+    cost_type m_cost; /// Custo da solução atual
+
+    /*! Altura máxima de um multiconjunto de alturas. O(1). */
+    static dim_type max_height(const std::map<dim_type, size_t>& heights) {
+        return heights.empty() ? dim_type(0) : heights.rbegin()->first;
+    }
+
+    /*! Modifica a altura de um nível, atualizando o custo. O(log L). */
+    void set_height(size_t level, dim_type height) {
+        dim_type delta = height - m_level_height[level];
+        if (delta == dim_type(0)) {
+            return;
+        }
+
+        // Todos os itens acima do nível sobem (ou descem) junto com ele.
+        m_cost += delta * m_weight_tree.suffix_sum(level + 1);
+        m_height_tree.add(level, delta);
+        m_level_height[level] = height;
+    }
+
+    /*! Modifica o peso de um nível, atualizando o custo. O(log L). */
+    void add_weight(size_t level, cost_type delta) {
+        m_cost += delta * base(level);
+        m_weight_tree.add(level, delta);
+        m_level_weight[level] += delta;
+    }
+
+  public:
+    /*! Constrói um estado sem níveis para uma instância. */
+    level_state(const instance_t& instance)
+        : m_instance(instance), m_cost(0) {}
+
+    /*! Constrói o estado correspondente a uma solução. O(n log n). */
+    level_state(const instance_t& instance, const solution_t& solution)
+        : level_state(instance) {
+        reserve(solution.size());
+        for (const auto& level : solution) {
+            size_t index = push_level();
+            for (size_t i : level) {
+                insert(index, i);
+            }
+        }
+    }
+
+    /*! Número de níveis. */
+    size_t size() const { return m_level_height.size(); }
+
+    void reserve(size_t new_cap) {
+        m_heights.reserve(new_cap);
+        m_level_height.reserve(new_cap);
+        m_level_weight.reserve(new_cap);
+        m_height_tree.reserve(new_cap);
+        m_weight_tree.reserve(new_cap);
+    }
+
+    /*! Adiciona um nível vazio no topo da pilha. O(log L) amortizado. */
+    size_t push_level() {
+        m_heights.emplace_back();
+        m_level_height.push_back(dim_type(0));
+        m_level_weight.push_back(cost_type(0));
+        m_height_tree.push_back(dim_type(0));
+        m_weight_tree.push_back(cost_type(0));
+        return size() - 1;
+    }
+
+    /*! Altura de um nível. O(1). */
+    dim_type height(size_t level) const { return m_level_height[level]; }
+
+    /*! Peso total de um nível. O(1). */
+    cost_type weight(size_t level) const { return m_level_weight[level]; }
+
+    /*! Altura da base de um nível. O(log L). */
+    dim_type base(size_t level) const {
+        return m_height_tree.prefix_sum(level);
+    }
+
+    /*! Altura total da pilha de níveis. O(log L). */
+    dim_type total_height() const { return m_height_tree.sum(); }
+
+    /*! Custo da solução representada. O(1). */
+    cost_type cost() const { return m_cost; }
+
+    /**
+     * Variação no custo caso a altura de um nível passe a ser a altura dada.
+     * O(log L).
+     */
+    cost_type height_delta(size_t level, dim_type height) const {
+        dim_type delta = height - m_level_height[level];
+        return delta * m_weight_tree.suffix_sum(level + 1);
+    }
+
+    /**
+     * Variação no custo caso um retângulo seja inserido em um nível.
+     * O(log L).
+     */
+    cost_type insert_delta(size_t level, size_t rect) const {
+        const auto& r = m_instance.rects[rect];
+        dim_type height = std::max(m_level_height[level], r.height);
+        return r.weight * base(level) + height_delta(level, height);
+    }
+
+    /*! Insere um retângulo em um nível. O(log L + log n). */
+    void insert(size_t level, size_t rect) {
+        assert(level < size());
+        const auto& r = m_instance.rects[rect];
+        m_heights[level][r.height]++;
+        add_weight(level, r.weight);
+        set_height(level, max_height(m_heights[level]));
+    }
+
+    /*! Remove um retângulo de um nível. O(log L + log n). */
+    void remove(size_t level, size_t rect) {
+        assert(level < size());
+        const auto& r = m_instance.rects[rect];
+        auto it = m_heights[level].find(r.height);
+        assert(it != m_heights[level].end());
+        if (--it->second == 0) {
+            m_heights[level].erase(it);
+        }
+        add_weight(level, -r.weight);
+        set_height(level, max_height(m_heights[level]));
+    }
+};
+
+} // namespace strip_packing::util
+
+#endif // STRIP_PACKING_UTIL_LEVEL_STATE_HPP
@@ -0,0 +1,276 @@
+#ifndef STRIP_PACKING_UTIL_MEMORY_HPP
+#define STRIP_PACKING_UTIL_MEMORY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace strip_packing::util::memory {
+
+/**
+ * Instrumentação do uso de memória por fase de execução.
+ *
+ * O pico e o uso atual de memória residente (RSS) são lidos de
+ * /proc/self/status. O pico é reiniciado no começo de cada fase, quando o
+ * sistema permite (escrevendo em /proc/self/clear_refs); caso contrário, ele
+ * é o pico do processo até o fim da fase.
+ *
+ * Opcionalmente, com STRIP_PACKING_COUNT_ALLOCATIONS definido, os operadores
+ * globais `new` e `delete` são substituídos por versões que contam o número
+ * e os bytes de alocações vivas, além do pico de bytes vivos. Nesse caso,
+ * este cabeçalho deve ser incluído com a definição em uma única unidade de
+ * tradução do executável.
+ */
+
+namespace detail {
+
+inline std::atomic<uint64_t> allocations = 0; /// Alocações feitas
+inline std::atomic<uint64_t> allocated = 0;   /// Bytes alocados
+inline std::atomic<int64_t> live = 0;         /// Alocações vivas
+inline std::atomic<int64_t> live_bytes = 0;   /// Bytes vivos
+inline std::atomic<int64_t> peak_bytes = 0;   /// Pico de bytes vivos
+
+inline void on_allocate(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated.fetch_add(size, std::memory_order_relaxed);
+    live.fetch_add(1, std::memory_order_relaxed);
+    int64_t bytes =
+        live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (bytes > peak && !peak_bytes.compare_exchange_weak(
+                               peak, bytes, std::memory_order_relaxed)) {
+    }
+}
+
+inline void on_free(size_t size) {
+    live.fetch_sub(1, std::memory_order_relaxed);
+    live_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+/*! Lê um campo (em kB) de /proc/self/status, ou 0 se não houver. */
+inline size_t read_status(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    size_t value;
+    while (status >> key) {
+        if (key == field + ":" && status >> value) {
+            return value;
+        }
+        status.ignore(1 << 10, '\n');
+    }
+    return 0;
+}
+
+} // namespace detail
+
+/*! Se as alocações são contadas (STRIP_PACKING_COUNT_ALLOCATIONS). */
+constexpr bool counting() {
+#ifdef STRIP_PACKING_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*! Uso de memória em um instante. */
+struct usage {
+    size_t rss_kb;         /// Memória residente
+    size_t peak_rss_kb;    /// Pico de memória residente
+    uint64_t allocations;  /// Alocações feitas (acumulado)
+    uint64_t allocated;    /// Bytes alocados (acumulado)
+    int64_t live;          /// Alocações vivas
+    int64_t live_bytes;    /// Bytes vivos
+    int64_t peak_bytes;    /// Pico de bytes vivos
+};
+
+/*! Uso de memória atual. */
+inline usage current() {
+    return {detail::read_status("VmRSS"), detail::read_status("VmHWM"),
+            detail::allocations.load(), detail::allocated.load(),
+            detail::live.load(), detail::live_bytes.load(),
+            detail::peak_bytes.load()};
+}
+
+/**
+ * Reinicia os picos de memória residente e de bytes vivos. Devolve se o pico
+ * de memória residente pôde ser reiniciado.
+ */
+inline bool reset_peak() {
+    detail::peak_bytes.store(detail::live_bytes.load());
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    return bool(clear_refs << "5" << std::flush);
+}
+
+/**
+ * Registro do uso de memória por fase.
+ *
+ * Cada fase é delimitada por `begin` e `end` (ou por um `scope`), e registra
+ * o pico de memória residente e de bytes vivos durante a fase, o número e os
+ * bytes de alocações feitas nela e o que continua vivo ao fim dela.
+ */
+class profiler {
+  private:
+    struct record {
+        std::string phase;
+        usage start, end;
+        bool peak_reset; /// Se o pico de RSS foi reiniciado no início
+    };
+
+    std::vector<record> m_records;
+    bool m_open = false;
+
+  public:
+    /*! Começa uma fase, terminando a anterior, se houver. */
+    void begin(std::string phase) {
+        end();
+        bool reset = reset_peak();
+        m_records.push_back({std::move(phase), current(), {}, reset});
+        m_open = true;
+    }
+
+    /*! Termina a fase atual. */
+    void end() {
+        if (m_open) {
+            m_records.back().end = current();
+            m_open = false;
+        }
+    }
+
+    /*! Fase delimitada pelo tempo de vida do objeto. */
+    class scope {
+      private:
+        profiler* m_profiler;
+
+      public:
+        scope(profiler* p, std::string phase) : m_profiler(p) {
+            if (m_profiler) {
+                m_profiler->begin(std::move(phase));
+            }
+        }
+        ~scope() {
+            if (m_profiler) {
+                m_profiler->end();
+            }
+        }
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+    };
+
+    /*! Escreve uma tabela com o uso de memória de cada fase. */
+    void write(std::ostream& out) const {
+        out << "[Memory usage per phase]" << std::endl;
+        out << "Allocation counting: " << (counting() ? "on" : "off")
+            << std::endl;
+        out << std::left << std::setw(20) << "phase" << std::right
+            << std::setw(14) << "peak_rss_kb" << std::setw(14) << "rss_kb";
+        if (counting()) {
+            out << std::setw(14) << "allocs" << std::setw(16) << "alloc_bytes"
+                << std::setw(14) << "live" << std::setw(16) << "live_bytes"
+                << std::setw(16) << "peak_bytes";
+        }
+        out << std::endl;
+
+        for (const auto& r : m_records) {
+            out << std::left << std::setw(20) << r.phase << std::right
+                << std::setw(13) << r.end.peak_rss_kb
+                << (r.peak_reset ? ' ' : '*') << std::setw(14)
+                << r.end.rss_kb;
+            if (counting()) {
+                out << std::setw(14) << r.end.allocations - r.start.allocations
+                    << std::setw(16) << r.end.allocated - r.start.allocated
+                    << std::setw(14) << r.end.live << std::setw(16)
+                    << r.end.live_bytes << std::setw(16) << r.end.peak_bytes;
+            }
+            out << std::endl;
+        }
+
+        bool any_unreset = std::any_of(
+            m_records.begin(), m_records.end(),
+            [](const record& r) { return !r.peak_reset; });
+        if (any_unreset) {
+            out << "* peak of the whole process up to the end of the phase"
+                << std::endl;
+        }
+    }
+};
+
+} // namespace strip_packing::util::memory
+
+#ifdef STRIP_PACKING_COUNT_ALLOCATIONS
+
+// Substituição dos operadores globais de alocação. O tamanho de cada bloco é
+// guardado antes dele, para ser descontado na liberação. As versões com
+// alinhamento estendido não são substituídas (e não são contadas).
+
+namespace strip_packing::util::memory::detail {
+inline constexpr size_t HEADER = alignof(std::max_align_t);
+} // namespace strip_packing::util::memory::detail
+
+void* operator new(std::size_t size) {
+    using namespace strip_packing::util::memory::detail;
+    void* block = std::malloc(size + HEADER);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<std::size_t*>(block) = size;
+    on_allocate(size);
+    return static_cast<char*>(block) + HEADER;
+}
+
+void operator delete(void* ptr) noexcept {
+    using namespace strip_packing::util::memory::detail;
+    if (!ptr) {
+        return;
+    }
+    // O endereço é calculado como inteiro porque, após inlining, o
+    // compilador pode ver o ponteiro como o início de um objeto e acusar um
+    // acesso fora dos limites.
+    auto* block = reinterpret_cast<std::size_t*>(
+        reinterpret_cast<std::uintptr_t>(ptr) - HEADER);
+    on_free(*block);
+    std::free(block);
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    operator delete(ptr);
+}
+
+#endif // STRIP_PACKING_COUNT_ALLOCATIONS
+
+#endif // STRIP_PACKING_UTIL_MEMORY_HPP
@@ -0,0 +1,250 @@
+#ifndef STRIP_PACKING_UTIL_PERF_HPP
+#define STRIP_PACKING_UTIL_PERF_HPP
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace strip_packing::util::perf {
+
+/**
+ * Contadores de desempenho do hardware por fase de execução.
+ *
+ * Os contadores (ciclos, instruções, falhas de cache e erros de predição de
+ * desvio) são abertos com `perf_event_open` para o processo, em modo de
+ * usuário, herdados pelas threads criadas depois da abertura. A leitura de um
+ * contador herdado soma as contagens de todas essas threads, vivas ou já
+ * terminadas, então os contadores devem ser abertos antes da criação das
+ * threads de trabalho.
+ *
+ * Quando o sistema não permite a abertura de um contador (por exemplo, em
+ * contêineres sem permissão, com /proc/sys/kernel/perf_event_paranoid alto ou
+ * em máquinas virtuais sem PMU), ele é marcado como indisponível, e o motivo
+ * é mostrado no relatório.
+ */
+
+/*! Eventos medidos. */
+enum event : size_t {
+    cycles,
+    instructions,
+    cache_misses,
+    branch_misses,
+    EVENTS
+};
+
+/*! Nomes dos eventos, na ordem de `event`. */
+inline const std::array<const char*, EVENTS> event_names = {
+    "cycles", "instructions", "cache_misses", "branch_misses"};
+
+/*! Valores dos contadores em um instante. */
+using reading = std::array<uint64_t, EVENTS>;
+
+/*! Conjunto de contadores abertos para o processo. */
+class counters {
+  private:
+    std::array<int, EVENTS> m_fd;
+    std::string m_error; /// Motivo da primeira falha de abertura
+
+  public:
+    counters() {
+        m_fd.fill(-1);
+#ifdef __linux__
+        const std::array<uint64_t, EVENTS> configs = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (size_t e = 0; e < EVENTS; e++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[e];
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+            m_fd[e] = syscall(SYS_perf_event_open, &attr, 0, -1, -1,
+                              PERF_FLAG_FD_CLOEXEC);
+            if (m_fd[e] < 0 && m_error.empty()) {
+                m_error = std::string(event_names[e]) + ": " +
+                          std::strerror(errno);
+            }
+        }
+#else
+        m_error = "not supported on this platform";
+#endif
+    }
+
+    ~counters() {
+#ifdef __linux__
+        for (int fd : m_fd) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    counters(const counters&) = delete;
+    counters& operator=(const counters&) = delete;
+
+    /*! Se o contador de um evento está disponível. */
+    bool available(event e) const { return m_fd[e] >= 0; }
+
+    /*! Se algum contador está disponível. */
+    bool any() const {
+        for (int fd : m_fd) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*! Motivo da indisponibilidade do primeiro contador que falhou. */
+    const std::string& error() const { return m_error; }
+
+    /**
+     * Lê os contadores. Quando o kernel multiplexa os contadores, o valor é
+     * extrapolado pela fração do tempo em que o contador esteve ativo.
+     * Contadores indisponíveis são lidos como 0.
+     */
+    reading read() const {
+        reading values{};
+#ifdef __linux__
+        for (size_t e = 0; e < EVENTS; e++) {
+            uint64_t data[3]; // Valor, tempo habilitado e tempo ativo
+            if (m_fd[e] < 0 ||
+                ::read(m_fd[e], data, sizeof(data)) != sizeof(data)) {
+                continue;
+            }
+            values[e] = data[2] == 0 || data[2] == data[1]
+                            ? data[0]
+                            : uint64_t(double(data[0]) * data[1] / data[2]);
+        }
+#endif
+        return values;
+    }
+};
+
+/**
+ * Registro dos contadores de hardware por fase.
+ *
+ * Cada fase é delimitada por `begin` e `end` (ou por um `scope`), e registra
+ * a diferença dos contadores entre o início e o fim dela, somada entre todas
+ * as threads (veja `counters`).
+ */
+class profiler {
+  private:
+    struct record {
+        std::string phase;
+        reading start, end;
+    };
+
+    counters m_counters;
+    std::vector<record> m_records;
+    bool m_open = false;
+
+  public:
+    /*! Contadores usados pelo registro. */
+    const counters& source() const { return m_counters; }
+
+    /*! Começa uma fase, terminando a anterior, se houver. */
+    void begin(std::string phase) {
+        end();
+        m_records.push_back({std::move(phase), m_counters.read(), {}});
+        m_open = true;
+    }
+
+    /*! Termina a fase atual. */
+    void end() {
+        if (m_open) {
+            m_records.back().end = m_counters.read();
+            m_open = false;
+        }
+    }
+
+    /*! Fase delimitada pelo tempo de vida do objeto. */
+    class scope {
+      private:
+        profiler* m_profiler;
+
+      public:
+        scope(profiler* p, std::string phase) : m_profiler(p) {
+            if (m_profiler) {
+                m_profiler->begin(std::move(phase));
+            }
+        }
+        ~scope() {
+            if (m_profiler) {
+                m_profiler->end();
+            }
+        }
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+    };
+
+    /**
+     * Escreve uma tabela com os contadores de cada fase e as instruções por
+     * ciclo (IPC). Contadores indisponíveis são mostrados como "-".
+     */
+    void write(std::ostream& out) const {
+        out << "[Hardware counters per phase]" << std::endl;
+        if (!m_counters.any()) {
+            out << "Hardware counters unavailable (" << m_counters.error()
+                << ")" << std::endl;
+            return;
+        }
+        if (!m_counters.error().empty()) {
+            out << "Some counters unavailable (" << m_counters.error() << ")"
+                << std::endl;
+        }
+
+        out << std::left << std::setw(20) << "phase" << std::right;
+        for (size_t e = 0; e < EVENTS; e++) {
+            out << std::setw(18) << event_names[e];
+        }
+        out << std::setw(8) << "ipc" << std::endl;
+
+        auto field = [&](const record& r, event e) {
+            if (m_counters.available(e)) {
+                out << std::setw(18) << r.end[e] - r.start[e];
+            } else {
+                out << std::setw(18) << "-";
+            }
+        };
+        for (const auto& r : m_records) {
+            out << std::left << std::setw(20) << r.phase << std::right;
+            for (size_t e = 0; e < EVENTS; e++) {
+                field(r, event(e));
+            }
+
+            uint64_t c = r.end[cycles] - r.start[cycles];
+            uint64_t i = r.end[instructions] - r.start[instructions];
+            if (m_counters.available(cycles) &&
+                m_counters.available(instructions) && c > 0) {
+                out << std::setw(8) << std::fixed << std::setprecision(2)
+                    << double(i) / c << std::defaultfloat;
+            } else {
+                out << std::setw(8) << "-";
+            }
+            out << std::endl;
+        }
+    }
+};
+
+} // namespace strip_packing::util::perf
+
+#endif // STRIP_PACKING_UTIL_PERF_HPP
@@ -0,0 +1,313 @@
+#ifndef STRIP_PACKING_UTIL_SOCKET_HPP
+#define STRIP_PACKING_UTIL_SOCKET_HPP
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace strip_packing::util {
+
+/**
+ * Endereço de um socket local ou TCP.
+ *
+ * Endereços da forma "unix:/caminho" correspondem a sockets de domínio Unix,
+ * e endereços da forma "host:porta" a sockets TCP.
+ */
+struct endpoint {
+    bool unix_domain;  /// Se é um socket de domínio Unix
+    std::string host;  /// Host (TCP) ou caminho (Unix)
+    std::string port;  /// Porta (TCP)
+
+    static endpoint parse(const std::string& address) {
+        if (address.rfind("unix:", 0) == 0) {
+            return {true, address.substr(5), ""};
+        }
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos) {
+            throw std::invalid_argument("invalid endpoint " + address +
+                                        " (expected host:port or unix:path)");
+        }
+        return {false, address.substr(0, colon), address.substr(colon + 1)};
+    }
+
+    std::string str() const {
+        return unix_domain ? "unix:" + host : host + ":" + port;
+    }
+};
+
+/*! Descritor de socket com fechamento automático. */
+class socket_fd {
+  private:
+    int m_fd;
+
+  public:
+    explicit socket_fd(int fd = -1) : m_fd(fd) {}
+    socket_fd(const socket_fd&) = delete;
+    socket_fd(socket_fd&& other) : m_fd(other.m_fd) { other.m_fd = -1; }
+    ~socket_fd() { close(); }
+
+    socket_fd& operator=(const socket_fd&) = delete;
+    socket_fd& operator=(socket_fd&& other) {
+        if (this != &other) {
+            close();
+            m_fd = other.m_fd;
+            other.m_fd = -1;
+        }
+        return *this;
+    }
+
+    int get() const { return m_fd; }
+    bool valid() const { return m_fd >= 0; }
+
+    void close() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+};
+
+namespace detail {
+
+[[noreturn]] inline void throw_errno(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+/*! Executa uma função para cada endereço TCP resolvido de um endpoint. */
+template <typename F>
+inline socket_fd for_each_address(const endpoint& ep, bool passive, F&& f) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+    addrinfo* result;
+    const char* host = ep.host.empty() ? nullptr : ep.host.c_str();
+    int status = getaddrinfo(host, ep.port.c_str(), &hints, &result);
+    if (status != 0) {
+        throw std::runtime_error("cannot resolve " + ep.str() + ": " +
+                                 gai_strerror(status));
+    }
+
+    socket_fd fd;
+    for (addrinfo* ai = result; ai != nullptr && !fd.valid(); ai = ai->ai_next) {
+        socket_fd candidate(
+            ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol));
+        if (candidate.valid() && f(candidate.get(), ai->ai_addr,
+                                   ai->ai_addrlen)) {
+            fd = std::move(candidate);
+        }
+    }
+    freeaddrinfo(result);
+    return fd;
+}
+
+/**
+ * Conecta um socket, esperando no máximo `timeout` segundos (0 para esperar
+ * indefinidamente). Devolve se a conexão foi estabelecida.
+ */
+inline bool connect_within(int fd, const sockaddr* addr, socklen_t len,
+                           double timeout) {
+    if (timeout <= 0) {
+        return ::connect(fd, addr, len) == 0;
+    }
+
+    // A conexão é feita em modo não bloqueante e esperada com poll.
+    int flags = ::fcntl(fd, F_GETFL);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+        return false;
+    }
+    bool connected = ::connect(fd, addr, len) == 0;
+    if (!connected && errno == EINPROGRESS) {
+        pollfd p = {fd, POLLOUT, 0};
+        int error = 0;
+        socklen_t size = sizeof(error);
+        connected = ::poll(&p, 1, int(timeout * 1000)) == 1 &&
+                    ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) ==
+                        0 &&
+                    error == 0;
+    }
+    return connected && ::fcntl(fd, F_SETFL, flags) == 0;
+}
+
+inline sockaddr_un unix_address(const endpoint& ep) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (ep.host.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("socket path too long: " + ep.host);
+    }
+    std::strcpy(addr.sun_path, ep.host.c_str());
+    return addr;
+}
+
+} // namespace detail
+
+/*! Cria um socket escutando conexões em um endpoint. */
+inline socket_fd listen_on(const endpoint& ep, int backlog = 16) {
+    if (ep.unix_domain) {
+        socket_fd fd(::socket(AF_UNIX, SOCK_STREAM, 0));
+        sockaddr_un addr = detail::unix_address(ep);
+        ::unlink(ep.host.c_str());
+        if (!fd.valid() ||
+            ::bind(fd.get(), (sockaddr*)&addr, sizeof(addr)) != 0 ||
+            ::listen(fd.get(), backlog) != 0) {
+            detail::throw_errno("cannot listen on " + ep.str());
+        }
+        return fd;
+    }
+
+    socket_fd fd = detail::for_each_address(
+        ep, true, [&](int fd, const sockaddr* addr, socklen_t len) {
+            int yes = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+            return ::bind(fd, addr, len) == 0 && ::listen(fd, backlog) == 0;
+        });
+    if (!fd.valid()) {
+        detail::throw_errno("cannot listen on " + ep.str());
+    }
+    return fd;
+}
+
+/**
+ * Aceita uma conexão em um socket que escuta conexões, guardando-a em
+ * `conn` (inválido se a tentativa falhou).
+ *
+ * Falhas transitórias (interrupção por sinal, conexão abortada pelo cliente)
+ * apenas devolvem um descritor inválido. Quando faltam descritores ou
+ * memória, a chamada espera um pouco antes de devolver, para que um laço de
+ * aceitação não ocupe a CPU enquanto a falha persiste. Devolve `false` nas
+ * demais falhas, em que o socket não aceita mais conexões (por exemplo,
+ * depois de `shutdown`), com o erro em `errno`.
+ */
+inline bool accept_from(int listener, socket_fd& conn) {
+    int fd = ::accept(listener, nullptr, nullptr);
+    int error = errno;
+    conn = socket_fd(fd);
+    if (conn.valid()) {
+        return true;
+    }
+    switch (error) {
+    case EINTR:
+    case ECONNABORTED:
+        return true;
+    case EMFILE:
+    case ENFILE:
+    case ENOBUFS:
+    case ENOMEM:
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return true;
+    default:
+        errno = error;
+        return false;
+    }
+}
+
+/**
+ * Conecta a um endpoint, esperando no máximo `timeout` segundos por endereço
+ * (0 para esperar indefinidamente). Devolve um descritor inválido caso a
+ * conexão não possa ser estabelecida (por exemplo, se o outro lado ainda não
+ * subiu).
+ */
+inline socket_fd connect_to(const endpoint& ep, double timeout = 0) {
+    if (ep.unix_domain) {
+        socket_fd fd(::socket(AF_UNIX, SOCK_STREAM, 0));
+        sockaddr_un addr = detail::unix_address(ep);
+        if (!fd.valid() ||
+            !detail::connect_within(fd.get(), (sockaddr*)&addr, sizeof(addr),
+                                    timeout)) {
+            return socket_fd();
+        }
+        return fd;
+    }
+
+    return detail::for_each_address(
+        ep, false, [timeout](int fd, const sockaddr* addr, socklen_t len) {
+            if (!detail::connect_within(fd, addr, len, timeout)) {
+                return false;
+            }
+            int yes = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+            return true;
+        });
+}
+
+/*! Escreve um buffer inteiro em um socket. Devolve falso em caso de erro. */
+inline bool send_all(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t sent = ::send(fd, p, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        p += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+/*! Lê exatamente um número dado de bytes. Devolve falso em caso de erro. */
+inline bool recv_all(int fd, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = ::recv(fd, p, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        p += received;
+        size -= received;
+    }
+    return true;
+}
+
+/**
+ * Envia uma mensagem prefixada pelo seu tamanho (u32, ordem de bytes de
+ * rede).
+ */
+inline bool send_frame(int fd, const std::vector<char>& payload) {
+    uint32_t size = htonl(uint32_t(payload.size()));
+    return send_all(fd, &size, sizeof(size)) &&
+           send_all(fd, payload.data(), payload.size());
+}
+
+/*! Recebe uma mensagem prefixada pelo seu tamanho. */
+inline bool recv_frame(int fd, std::vector<char>& payload,
+                       size_t max_size = size_t(1) << 30) {
+    uint32_t size;
+    if (!recv_all(fd, &size, sizeof(size))) {
+        return false;
+    }
+    size = ntohl(size);
+    if (size > max_size) {
+        return false;
+    }
+    payload.resize(size);
+    return recv_all(fd, payload.data(), size);
+}
+
+} // namespace strip_packing::util
+
+#endif // STRIP_PACKING_UTIL_SOCKET_HPP
@@ -0,0 +1,82 @@
+#ifndef STRIP_PACKING_UTIL_SPSC_RING_HPP
+#define STRIP_PACKING_UTIL_SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace strip_packing::util {
+
+/**
+ * Fila circular sem travas (lock-free) com um único produtor e um único
+ * consumidor.
+ *
+ * A capacidade é arredondada para a próxima potência de dois. Os índices de
+ * leitura e escrita crescem indefinidamente e ficam em linhas de cache
+ * separadas, para que produtor e consumidor não disputem a mesma linha.
+ *
+ * @param T - tipo dos elementos da fila.
+ */
+template <typename T> class spsc_ring {
+  private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> m_buffer;
+    size_t m_mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> m_head; /// Próxima leitura
+    alignas(CACHE_LINE) std::atomic<size_t> m_tail; /// Próxima escrita
+
+  public:
+    spsc_ring(size_t capacity) : m_head(0), m_tail(0) {
+        size_t cap = 1;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        m_buffer.resize(cap);
+        m_mask = cap - 1;
+    }
+
+    size_t capacity() const { return m_buffer.size(); }
+
+    /**
+     * Insere um elemento na fila, caso haja espaço. Só pode ser chamado pelo
+     * produtor. O(1).
+     */
+    bool try_push(T value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == capacity()) {
+            return false;
+        }
+        m_buffer[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove um elemento da fila, caso ela não esteja vazia. Só pode ser
+     * chamado pelo consumidor. O(1).
+     */
+    bool try_pop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(m_buffer[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*! Se a fila está vazia (no momento da chamada). */
+    bool empty() const {
+        return m_head.load(std::memory_order_acquire) ==
+               m_tail.load(std::memory_order_acquire);
+    }
+};
+
+} // namespace strip_packing::util
+
+#endif // STRIP_PACKING_UTIL_SPSC_RING_HPP
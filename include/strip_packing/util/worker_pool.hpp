@@ -0,0 +1,105 @@
+#ifndef STRIP_PACKING_UTIL_WORKER_POOL_HPP
+#define STRIP_PACKING_UTIL_WORKER_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace strip_packing::util {
+
+/**
+ * Conjunto fixo de threads que executam tarefas de uma fila, em ordem de
+ * chegada.
+ *
+ * As threads são criadas uma única vez, na construção, e reaproveitadas por
+ * todas as tarefas. Ao destruir o conjunto, as tarefas em execução são
+ * aguardadas e as que ainda estão na fila são descartadas.
+ */
+class worker_pool {
+  public:
+    using task = std::function<void()>;
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<task> m_queue;
+    size_t m_running;
+    bool m_stop;
+
+    std::vector<std::thread> m_threads;
+
+    void work() {
+        while (true) {
+            task next;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+                if (m_stop) {
+                    return;
+                }
+                next = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_running++;
+            }
+            next();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running--;
+        }
+    }
+
+  public:
+    worker_pool(unsigned threads) : m_running(0), m_stop(false) {
+        threads = std::max(1u, threads);
+        for (unsigned i = 0; i < threads; i++) {
+            m_threads.emplace_back([this] { work(); });
+        }
+    }
+
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+    ~worker_pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    /*! Número de threads. */
+    unsigned size() const { return m_threads.size(); }
+
+    /*! Adiciona uma tarefa ao fim da fila. */
+    void submit(task t) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(t));
+        }
+        m_cv.notify_one();
+    }
+
+    /*! Número de tarefas na fila ou em execução. */
+    size_t load() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.size() + m_running;
+    }
+
+    /*! Número de tarefas na fila (sem contar as em execução). */
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.size();
+    }
+};
+
+} // namespace strip_packing::util
+
+#endif // STRIP_PACKING_UTIL_WORKER_POOL_HPP
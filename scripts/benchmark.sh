@@ -0,0 +1,172 @@
+#!/usr/bin/bash
+#
+# Mede o tempo até atingir custos alvo (time-to-target) de configurações do
+# executável de heurísticas sobre o catálogo de instâncias.
+#
+# Uso: scripts/benchmark.sh [-s SEMENTES] [-t SEGUNDOS] [-x SEGUNDOS]
+#                           [-o DIR] [NOME=ARGUMENTOS ...]
+#
+#   -s  número de sementes por instância e configuração (padrão: 5)
+#   -t  limite de tempo de cada execução (padrão: 60)
+#   -x  limite de tempo do algoritmo exato, usado para obter o ótimo das
+#       instâncias em que ele termina (padrão: 10; 0 desabilita)
+#   -o  pasta de saída (padrão: output/benchmark)
+#
+# Cada configuração é um nome seguido dos argumentos extras do executável,
+# por exemplo:
+#
+#   scripts/benchmark.sh -s 3 -t 30 base= bounded=--bounded-decode \
+#       "ls=--intensify 2"
+#
+# Os alvos são o custo de referência mais 1% e mais 0.1%, e o ótimo, caso o
+# algoritmo exato o prove. A referência é o ótimo, quando conhecido, ou o
+# melhor custo encontrado por qualquer execução. Execuções que não atingem um
+# alvo têm tempo infinito (inf).
+#
+# Saída:
+#   runs.csv    - tempo até cada alvo de cada execução
+#   report.csv  - por configuração, classe de instância e alvo: taxa de
+#                 sucesso e percentis 50, 90 e 100 do tempo até o alvo
+#
+# A classe de uma instância aleatória é o seu número de retângulos (por
+# exemplo, random-1000), e as instâncias adversárias formam uma classe só.
+
+BUILD=${BUILD:-build}
+SEEDS=5
+TIME_LIMIT=60
+EXACT_LIMIT=10
+OUTPUT=output/benchmark
+
+while getopts "s:t:x:o:" OPT
+do
+    case $OPT in
+        s) SEEDS=$OPTARG ;;
+        t) TIME_LIMIT=$OPTARG ;;
+        x) EXACT_LIMIT=$OPTARG ;;
+        o) OUTPUT=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+CONFIGS=("$@")
+if ((${#CONFIGS[@]} == 0))
+then
+    CONFIGS=("default=")
+fi
+
+mkdir -p $OUTPUT
+
+instance_class() {
+    case $1 in
+        random-*) echo $1 | cut -d- -f1,2 ;;
+        *) echo adversarial ;;
+    esac
+}
+
+# Multiplica um custo (possivelmente em notação científica) por um fator.
+scale() {
+    awk -v cost=$1 -v factor=$2 'BEGIN { printf "%.12g", cost * factor }'
+}
+
+# Primeiro tempo em que o custo registrado é menor ou igual ao alvo.
+time_to_target() {
+    awk -F, -v target=$2 '
+        NR > 1 && $2 <= target { print $1; found = 1; exit }
+        END { if (!found) print "inf" }' $1
+}
+
+echo "config,instance,class,seed,target,time" > $OUTPUT/runs.csv
+
+for INSTANCE in instances/random/*.yml instances/adversarial/*.yml
+do
+    INSTANCE_NAME=$(basename $INSTANCE .yml)
+    CLASS=$(instance_class $INSTANCE_NAME)
+    INSTANCE_DIR=$OUTPUT/$INSTANCE_NAME
+    mkdir -p $INSTANCE_DIR
+
+    OPTIMAL=
+    if [ "$EXACT_LIMIT" != 0 ]
+    then
+        $BUILD/mc859-strip-packing-exact --time-limit $EXACT_LIMIT \
+            -o $INSTANCE_DIR $INSTANCE > /dev/null
+        if grep -q "Optimal: yes" $INSTANCE_DIR/exact.txt
+        then
+            OPTIMAL=$(grep -Po "Cost: \K.*" $INSTANCE_DIR/exact.txt)
+        fi
+    fi
+
+    for CONFIG in "${CONFIGS[@]}"
+    do
+        NAME=${CONFIG%%=*}
+        ARGS=${CONFIG#*=}
+        for ((SEED = 1; SEED <= SEEDS; SEED++))
+        do
+            RUN_DIR=$INSTANCE_DIR/$NAME/$SEED
+            mkdir -p $RUN_DIR
+            echo "Running $INSTANCE_NAME with $NAME (seed $SEED)"
+            $BUILD/mc859-strip-packing-heuristics $ARGS -s $SEED \
+                --time-limit $TIME_LIMIT --progress $RUN_DIR/progress.csv \
+                -o $RUN_DIR $INSTANCE > $RUN_DIR/stdout.txt
+        done
+    done
+
+    # O custo de referência é o ótimo, ou o melhor custo de todas as
+    # execuções na instância.
+    if [ -n "$OPTIMAL" ]
+    then
+        REFERENCE=$OPTIMAL
+    else
+        REFERENCE=$(tail -qn 1 $INSTANCE_DIR/*/*/progress.csv |
+            cut -d, -f2 | sort -g | head -n 1)
+    fi
+
+    for CONFIG in "${CONFIGS[@]}"
+    do
+        NAME=${CONFIG%%=*}
+        for ((SEED = 1; SEED <= SEEDS; SEED++))
+        do
+            PROGRESS=$INSTANCE_DIR/$NAME/$SEED/progress.csv
+            for TARGET in 1% 0.1% optimal
+            do
+                case $TARGET in
+                    1%) COST=$(scale $REFERENCE 1.01) ;;
+                    0.1%) COST=$(scale $REFERENCE 1.001) ;;
+                    optimal)
+                        # O ótimo é escrito arredondado para 3 casas.
+                        [ -n "$OPTIMAL" ] || continue
+                        COST=$(awk -v cost=$OPTIMAL \
+                            'BEGIN { printf "%.12g", cost + 0.0005 }') ;;
+                esac
+                TIME=$(time_to_target $PROGRESS $COST)
+                echo "$NAME,$INSTANCE_NAME,$CLASS,$SEED,$TARGET,$TIME"
+            done
+        done
+    done >> $OUTPUT/runs.csv
+done
+
+# Percentis (pelo posto mais próximo) do tempo até cada alvo, agrupados por
+# configuração, classe e alvo. Os tempos de cada grupo chegam ordenados.
+{
+    echo "config,class,target,runs,success,p50,p90,p100"
+    tail -n +2 $OUTPUT/runs.csv |
+        sort -t, -k1,1 -k3,3 -k5,5 -k6,6g |
+        awk -F, '
+            function flush() {
+                if (n == 0) return
+                printf "%s,%s,%s,%d,%.3f,%s,%s,%s\n", config, class, target,
+                       n, ok / n, times[int(0.5 * n + 0.999999)],
+                       times[int(0.9 * n + 0.999999)], times[n]
+            }
+            $1 != config || $3 != class || $5 != target {
+                flush()
+                config = $1; class = $3; target = $5; n = 0; ok = 0
+            }
+            {
+                times[++n] = $6
+                if ($6 != "inf") ok++
+            }
+            END { flush() }'
+} > $OUTPUT/report.csv
+
+column -ts, $OUTPUT/report.csv 2> /dev/null || cat $OUTPUT/report.csv
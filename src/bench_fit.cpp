@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <strip_packing.hpp>
+#include <strip_packing/io.hpp>
+#include <strip_packing/util/sort.hpp>
+
+#include <argparse/argparse.hpp>
+
+using namespace strip_packing;
+using namespace strip_packing::heuristics;
+
+/*! Resultado das amostras de uma heurística em uma instância. */
+struct measurement {
+    double seconds = 0;                                    /// Tempo total
+    cost_type best = std::numeric_limits<cost_type>::max(); /// Melhor custo
+    cost_type total = 0;                                   /// Soma dos custos
+};
+
+/**
+ * Compara as heurísticas de first-fit e de encaixe por altura, em velocidade
+ * e qualidade, sobre as mesmas ordens de inserção: a ordem decrescente de
+ * densidade e ordens aleatórias.
+ */
+int main(int argc, char** argv) {
+    argparse::ArgumentParser program("mc859-strip-packing-bench-fit");
+
+    program.add_argument("-s", "--seed")
+        .default_value<unsigned>(0)
+        .metavar("N")
+        .help("seed for the random number generator.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("-n", "--samples")
+        .default_value<unsigned>(100)
+        .metavar("N")
+        .help("number of random insertion orders per instance.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("files").help("instance file names.").remaining();
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << program;
+        std::exit(1);
+    }
+
+    using fit_t = solution_t (*)(const instance_t&, const std::vector<size_t>&);
+    const std::pair<const char*, fit_t> fits[] = {
+        {"first-fit", constructive::first_fit},
+        {"height-fit", constructive::height_fit},
+    };
+
+    std::cout << "instance,n,order,heuristic,mean_ms,best_cost,mean_cost"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    unsigned samples = program.get<unsigned>("--samples");
+    auto files = program.get<std::vector<std::string>>("files");
+    for (const auto& filename : files) {
+        instance_t instance;
+        {
+            std::ifstream file(filename);
+            instance = io::read_instance(file);
+        }
+
+        // Todas as heurísticas recebem as mesmas ordens.
+        std::vector<std::pair<std::string, std::vector<size_t>>> orders;
+        orders.emplace_back(
+            "density", util::sort_permutation(
+                           instance.rects, [](const auto& a, const auto& b) {
+                               return a.weight * b.area() >
+                                      b.weight * a.area();
+                           }));
+
+        std::mt19937 rng(program.get<unsigned>("--seed"));
+        std::vector<size_t> order(instance.rects.size());
+        std::iota(order.begin(), order.end(), 0);
+        for (unsigned i = 0; i < samples; i++) {
+            std::shuffle(order.begin(), order.end(), rng);
+            orders.emplace_back("random", order);
+        }
+
+        for (const auto& [name, fit] : fits) {
+            measurement density, random;
+            for (const auto& [kind, permutation] : orders) {
+                auto& m = kind == "density" ? density : random;
+                auto start = std::chrono::steady_clock::now();
+                solution_t solution = fit(instance, permutation);
+                std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - start;
+
+                cost_type cost = instance.cost(solution);
+                m.seconds += elapsed.count();
+                m.best = std::min(m.best, cost);
+                m.total += cost;
+            }
+
+            auto report = [&](const char* kind, const measurement& m,
+                              unsigned count) {
+                if (count == 0) {
+                    return;
+                }
+                std::cout << filename << "," << instance.rects.size() << ","
+                          << kind << "," << name << ","
+                          << 1000 * m.seconds / count << "," << m.best << ","
+                          << m.total / count << std::endl;
+            };
+            report("density", density, 1);
+            report("random", random, samples);
+        }
+    }
+}
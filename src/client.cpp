@@ -0,0 +1,105 @@
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <strip_packing.hpp>
+#include <strip_packing/io.hpp>
+#include <strip_packing/service.hpp>
+#include <strip_packing/util/socket.hpp>
+
+#include <argparse/argparse.hpp>
+
+using namespace strip_packing;
+
+/*! Ponto de entrada. */
+int main(int argc, char** argv) {
+    argparse::ArgumentParser program("mc859-strip-packing-client");
+
+    program.add_argument("-c", "--connect")
+        .default_value<std::string>("unix:/tmp/mc859-strip-packing.sock")
+        .metavar("ENDPOINT")
+        .help("endpoint of the solver daemon (host:port or unix:path).");
+
+    program.add_argument("-s", "--seed")
+        .metavar("N")
+        .help("seed for the random number generator.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("-t", "--time-limit")
+        .default_value<double>(0)
+        .metavar("SECONDS")
+        .help("time budget of the request (0 means the daemon's default).")
+        .scan<'g', double>();
+
+    program.add_argument("-o", "--output")
+        .metavar("FILE")
+        .help("write the solution to a file instead of the standard output.");
+
+    program.add_argument("file").help("instance file name.");
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << program;
+        std::exit(1);
+    }
+
+    service::request req;
+    req.id = 1;
+    req.time_limit = program.get<double>("--time-limit");
+    if (auto s = program.present<unsigned>("-s")) {
+        req.seed = *s;
+    } else {
+        std::random_device rd;
+        req.seed = rd();
+    }
+    {
+        std::ifstream file(program.get("file"));
+        req.instance = io::read_instance(file);
+    }
+
+    auto endpoint = util::endpoint::parse(program.get("--connect"));
+    util::socket_fd fd = util::connect_to(endpoint);
+    if (!fd.valid() || !util::send_frame(fd.get(), service::encode(req))) {
+        std::cerr << "Cannot connect to " << endpoint.str() << std::endl;
+        return 1;
+    }
+
+    std::vector<char> payload;
+    while (util::recv_frame(fd.get(), payload)) {
+        auto res = service::decode_response(payload);
+        switch (res.kind) {
+        case service::response_kind::accepted:
+            std::cerr << "Accepted with " << res.iteration
+                      << " requests ahead" << std::endl;
+            break;
+        case service::response_kind::progress:
+            std::cerr << "Improved best solution: " << res.cost
+                      << ". Iteration " << res.iteration
+                      << ". Current time: " << res.time << "s" << std::endl;
+            break;
+        case service::response_kind::error:
+            std::cerr << "Error: " << res.message << std::endl;
+            return 1;
+        case service::response_kind::solution: {
+            std::cerr << "Solved in " << res.time << "s" << std::endl;
+            std::ofstream file;
+            if (auto output = program.present("--output")) {
+                file.open(*output);
+            }
+            std::ostream& out = file.is_open() ? file : std::cout;
+            out << std::fixed << std::setprecision(3);
+            io::print_solution(out, req.instance, res.solution);
+            return 0;
+        }
+        }
+    }
+
+    std::cerr << "Connection closed by the daemon" << std::endl;
+    return 1;
+}
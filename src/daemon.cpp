@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <strip_packing.hpp>
+#include <strip_packing/pipeline.hpp>
+#include <strip_packing/service.hpp>
+#include <strip_packing/util/deadline.hpp>
+#include <strip_packing/util/socket.hpp>
+#include <strip_packing/util/worker_pool.hpp>
+
+#include <argparse/argparse.hpp>
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+#include <sys/socket.h>
+
+using namespace strip_packing;
+
+/*! Flag de parada ativada por SIGINT/SIGTERM. */
+static std::atomic<bool> interrupted(false);
+
+/*! Socket de escuta, fechado pelo tratador de sinais para parar o serviço. */
+static std::atomic<int> listener_fd(-1);
+
+/**
+ * Tratador de sinais de interrupção.
+ *
+ * Desbloqueia a espera por conexões, de forma que o serviço termina após
+ * cancelar as requisições em andamento.
+ */
+extern "C" void handle_interrupt(int signal) {
+    interrupted.store(true);
+    ::shutdown(listener_fd.load(), SHUT_RDWR);
+    std::signal(signal, SIG_DFL);
+}
+
+/*! Conexão com um cliente. */
+struct connection {
+    util::socket_fd fd;
+    std::mutex send_mutex;
+
+    /**
+     * Se a conexão foi encerrada. Também serve de flag de cancelamento das
+     * requisições do cliente, que não têm mais para quem responder.
+     */
+    std::atomic<bool> closed;
+
+    connection(util::socket_fd&& socket)
+        : fd(std::move(socket)), closed(false) {}
+
+    /*! Envia uma resposta ao cliente, de forma segura entre threads. */
+    void send(const service::response& res) {
+        auto payload = service::encode(res);
+        std::lock_guard<std::mutex> lock(send_mutex);
+        if (!closed && !util::send_frame(fd.get(), payload)) {
+            closed = true;
+        }
+    }
+};
+
+/**
+ * Serviço de solução persistente.
+ *
+ * Mantém carregada a configuração do BRKGA e um conjunto fixo de threads de
+ * trabalho, e atende requisições de clientes conectados a um socket de
+ * domínio Unix ou TCP local (veja `service` para o protocolo).
+ *
+ * Cada requisição é enfileirada e resolvida por uma thread de trabalho com
+ * `pipeline::solve`, com um prazo próprio que começa a contar quando ela sai
+ * da fila. As novas melhores soluções são enviadas ao cliente conforme são
+ * encontradas, seguidas da solução final.
+ */
+class solver_daemon {
+  public:
+    struct config {
+        pipeline::options options;
+        std::string brkga_config;
+        unsigned workers;
+        double default_time_limit;
+        double max_time_limit;
+    };
+
+  private:
+    const config& m_config;
+    BRKGA::BrkgaParams m_brkga_params;
+    BRKGA::ControlParams m_control_params;
+
+    util::worker_pool m_workers;
+
+    /*! Thread de leitura de um cliente. */
+    struct reader {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> finished;
+    };
+
+    std::mutex m_connections_mutex;
+    std::vector<std::shared_ptr<connection>> m_connections; /// Conexões abertas
+    std::vector<reader> m_readers;
+
+    /*! Valida uma instância recebida. */
+    static void validate(const instance_t& instance) {
+        if (instance.rects.empty() || !(instance.recipient_length > 0)) {
+            throw std::invalid_argument("empty instance");
+        }
+        for (const auto& rect : instance.rects) {
+            if (!(rect.length > 0) || rect.length > instance.recipient_length ||
+                !(rect.height >= 0) || !(rect.weight >= 0)) {
+                throw std::invalid_argument("invalid rectangle");
+            }
+        }
+    }
+
+    /*! Prazo de uma requisição, limitado pelo prazo máximo do serviço. */
+    double time_limit(double requested) const {
+        double limit = requested > 0 ? requested : m_config.default_time_limit;
+        if (m_config.max_time_limit > 0 &&
+            (limit <= 0 || limit > m_config.max_time_limit)) {
+            limit = m_config.max_time_limit;
+        }
+        return limit;
+    }
+
+    /*! Resolve uma requisição, enviando o progresso e a solução. */
+    void solve(const std::shared_ptr<connection>& conn,
+               const service::request& req) {
+        if (conn->closed) {
+            return;
+        }
+
+        util::deadline deadline(time_limit(req.time_limit), &conn->closed);
+        std::minstd_rand rng(req.seed);
+        try {
+            solution_t solution = pipeline::solve(
+                req.instance, m_config.options, m_brkga_params,
+                m_control_params, rng, deadline,
+                [&](const pipeline::progress& p) {
+                    conn->send({req.id, service::response_kind::progress,
+                                p.time, p.iteration, p.best, {}, {}});
+                });
+
+            cost_type cost = req.instance.cost(solution);
+            conn->send({req.id, service::response_kind::solution,
+                        deadline.elapsed(), 0, cost, std::move(solution), {}});
+            std::cout << "Request " << req.id << ": "
+                      << req.instance.rects.size() << " rectangles, cost "
+                      << cost << " in " << deadline.elapsed() << "s"
+                      << std::endl;
+        } catch (const std::exception& err) {
+            conn->send({req.id, service::response_kind::error,
+                        deadline.elapsed(), 0, -1, {}, err.what()});
+        }
+    }
+
+    /*! Lê as requisições de um cliente, enfileirando-as. */
+    void read_requests(std::shared_ptr<connection> conn) {
+        std::vector<char> payload;
+        while (!interrupted && util::recv_frame(conn->fd.get(), payload)) {
+            service::request req{};
+            try {
+                req = service::decode_request(payload);
+                validate(req.instance);
+            } catch (const std::exception& err) {
+                conn->send({req.id, service::response_kind::error, 0, 0, -1,
+                            {}, err.what()});
+                continue;
+            }
+
+            // A confirmação é enviada antes de enfileirar a requisição, para
+            // que chegue ao cliente antes de qualquer progresso.
+            conn->send({req.id, service::response_kind::accepted, 0,
+                        uint32_t(m_workers.load()), -1, {}, {}});
+            auto shared = std::make_shared<service::request>(std::move(req));
+            m_workers.submit([this, conn, shared] { solve(conn, *shared); });
+        }
+        conn->closed = true;
+
+        // As requisições enfileiradas mantêm a conexão viva até terminarem,
+        // e o socket é fechado quando a última referência é liberada.
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        std::erase(m_connections, conn);
+    }
+
+    /*! Aguarda as threads de leitura de clientes já desconectados. */
+    void reap_readers() {
+        std::erase_if(m_readers, [](reader& r) {
+            if (!*r.finished) {
+                return false;
+            }
+            r.thread.join();
+            return true;
+        });
+    }
+
+  public:
+    solver_daemon(const config& conf)
+        : m_config(conf), m_workers(conf.workers) {
+        std::tie(m_brkga_params, m_control_params) =
+            BRKGA::readConfiguration(m_config.brkga_config);
+    }
+
+    ~solver_daemon() {
+        // Cancela as requisições em andamento e desbloqueia as leituras.
+        {
+            std::lock_guard<std::mutex> lock(m_connections_mutex);
+            for (auto& conn : m_connections) {
+                conn->closed = true;
+                ::shutdown(conn->fd.get(), SHUT_RDWR);
+            }
+        }
+        for (auto& r : m_readers) {
+            r.thread.join();
+        }
+    }
+
+    /*! Atende conexões em um endpoint até o serviço ser interrompido. */
+    void serve(const util::endpoint& endpoint) {
+        util::socket_fd listener = util::listen_on(endpoint);
+        listener_fd = listener.get();
+        std::cout << "Listening on " << endpoint.str() << " with "
+                  << m_workers.size() << " workers" << std::endl;
+
+        util::socket_fd fd;
+        while (!interrupted) {
+            if (!util::accept_from(listener.get(), fd)) {
+                std::cerr << "Cannot accept connections: "
+                          << std::strerror(errno) << std::endl;
+                break;
+            }
+            if (!fd.valid()) {
+                continue;
+            }
+            auto conn = std::make_shared<connection>(std::move(fd));
+            auto finished = std::make_shared<std::atomic<bool>>(false);
+            std::lock_guard<std::mutex> lock(m_connections_mutex);
+            reap_readers();
+            m_connections.push_back(conn);
+            m_readers.push_back(
+                {std::thread([this, conn, finished]() mutable {
+                     read_requests(std::move(conn));
+                     *finished = true;
+                 }),
+                 finished});
+        }
+        if (interrupted) {
+            std::cout << "Interrupted, shutting down" << std::endl;
+        }
+    }
+};
+
+/*! Ponto de entrada. */
+int main(int argc, char** argv) {
+    argparse::ArgumentParser program("mc859-strip-packing-daemon");
+
+    program.add_argument("-l", "--listen")
+        .default_value<std::string>("unix:/tmp/mc859-strip-packing.sock")
+        .metavar("ENDPOINT")
+        .help("endpoint to listen on (host:port or unix:path).");
+
+    program.add_argument("-w", "--workers")
+        .default_value<unsigned>(std::thread::hardware_concurrency())
+        .metavar("N")
+        .help("number of worker threads (requests solved in parallel).")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--brkga-config")
+        .default_value<std::string>("brkga.conf")
+        .metavar("FILE")
+        .help("BRKGA configuration file.");
+
+    program.add_argument("--no-brkga")
+        .default_value(false)
+        .implicit_value(true)
+        .help("disable BRKGA improvement.")
+        .nargs(0);
+
+    program.add_argument("--decoder")
+        .default_value<std::string>("next-fit")
+        .metavar("NAME")
+        .help("BRKGA chromosome decoder (next-fit, first-fit, best-fit or "
+              "height-fit).");
+
+    program.add_argument("--first-fit")
+        .default_value<unsigned>(500)
+        .metavar("N")
+        .help("number of random samples of the first fit heuristic.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--best-fit")
+        .default_value<unsigned>(500)
+        .metavar("N")
+        .help("number of random samples of the best fit heuristic.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--default-time-limit")
+        .default_value<double>(10)
+        .metavar("SECONDS")
+        .help("time budget of requests that do not specify one.")
+        .scan<'g', double>();
+
+    program.add_argument("--max-time-limit")
+        .default_value<double>(300)
+        .metavar("SECONDS")
+        .help("maximum time budget of a request (0 means no limit).")
+        .scan<'g', double>();
+
+    try {
+        program.parse_args(argc, argv);
+
+        auto decoder = program.get("--decoder");
+        const auto& fits = heuristics::constructive::fit_names;
+        if (std::find(fits.begin(), fits.end(), decoder) == fits.end()) {
+            throw std::runtime_error("Invalid decoder: " + decoder);
+        }
+    } catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << program;
+        std::exit(1);
+    }
+
+    pipeline::options options;
+    options.first_fit_samples = program.get<unsigned>("--first-fit");
+    options.best_fit_samples = program.get<unsigned>("--best-fit");
+    options.brkga = !program.get<bool>("--no-brkga");
+    options.decoder = program.get("--decoder");
+
+    solver_daemon::config conf = {
+        .options = options,
+        .brkga_config = program.get("--brkga-config"),
+        .workers = program.get<unsigned>("--workers"),
+        .default_time_limit = program.get<double>("--default-time-limit"),
+        .max_time_limit = program.get<double>("--max-time-limit")};
+
+    std::signal(SIGINT, handle_interrupt);
+    std::signal(SIGTERM, handle_interrupt);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    solver_daemon daemon(conf);
+    daemon.serve(util::endpoint::parse(program.get("--listen")));
+}
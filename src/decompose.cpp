@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <strip_packing.hpp>
+#include <strip_packing/decomposition.hpp>
+#include <strip_packing/io.hpp>
+#include <strip_packing/pipeline.hpp>
+#include <strip_packing/util/deadline.hpp>
+
+#include <argparse/argparse.hpp>
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+using namespace strip_packing;
+
+/**
+ * Resolve uma instância por decomposição em faixas (veja `decomposition`).
+ *
+ * Com `--scaling`, resolve a instância com 1, 2, 4, ... threads até o número
+ * dado, com as mesmas sementes, e reporta o tempo e a aceleração de cada
+ * execução em relação à execução com uma thread.
+ */
+int main(int argc, char** argv) {
+    argparse::ArgumentParser program("mc859-strip-packing-decompose");
+
+    program.add_argument("-s", "--seed")
+        .metavar("N")
+        .help("seed for the random number generator.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("-o", "--output")
+        .metavar("FILE")
+        .help("write the solution to a file.");
+
+    program.add_argument("-b", "--bands")
+        .default_value<unsigned>(0)
+        .metavar("N")
+        .help("number of bands (0 means one per --band-size rectangles).")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--band-size")
+        .default_value<unsigned>(2000)
+        .metavar("N")
+        .help("target number of rectangles per band when --bands is 0.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--key")
+        .default_value<std::string>("density")
+        .metavar("NAME")
+        .help("criterion used to split the bands (density or height).");
+
+    program.add_argument("--threads")
+        .default_value<unsigned>(std::thread::hardware_concurrency())
+        .metavar("N")
+        .help("number of bands solved in parallel.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--scaling")
+        .default_value(false)
+        .implicit_value(true)
+        .help("solve with 1, 2, 4, ... threads and report the speedup.")
+        .nargs(0);
+
+    program.add_argument("-t", "--time-limit")
+        .default_value<double>(60)
+        .metavar("SECONDS")
+        .help("time budget of each run (0 means no limit).")
+        .scan<'g', double>();
+
+    program.add_argument("--brkga-config")
+        .default_value<std::string>("brkga.conf")
+        .metavar("FILE")
+        .help("BRKGA configuration file.");
+
+    program.add_argument("--no-brkga")
+        .default_value(false)
+        .implicit_value(true)
+        .help("disable BRKGA improvement of the bands.")
+        .nargs(0);
+
+    program.add_argument("--decoder")
+        .default_value<std::string>("next-fit")
+        .metavar("NAME")
+        .help("BRKGA chromosome decoder (next-fit, first-fit, best-fit or "
+              "height-fit).");
+
+    program.add_argument("--first-fit")
+        .default_value<unsigned>(100)
+        .metavar("N")
+        .help("random samples of the first fit heuristic per band.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--best-fit")
+        .default_value<unsigned>(100)
+        .metavar("N")
+        .help("random samples of the best fit heuristic per band.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("file").help("instance file name.");
+
+    decomposition::key key;
+    try {
+        program.parse_args(argc, argv);
+        key = decomposition::parse_key(program.get("--key"));
+
+        auto decoder = program.get("--decoder");
+        const auto& fits = heuristics::constructive::fit_names;
+        if (std::find(fits.begin(), fits.end(), decoder) == fits.end()) {
+            throw std::runtime_error("Invalid decoder: " + decoder);
+        }
+    } catch (const std::exception& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << program;
+        std::exit(1);
+    }
+
+    instance_t instance;
+    {
+        std::ifstream file(program.get("file"));
+        instance = io::read_instance(file);
+    }
+
+    unsigned seed;
+    if (auto s = program.present<unsigned>("-s")) {
+        seed = *s;
+    } else {
+        std::random_device rd;
+        seed = rd();
+    }
+
+    size_t bands = program.get<unsigned>("--bands");
+    if (bands == 0) {
+        size_t size = std::max(1u, program.get<unsigned>("--band-size"));
+        bands = (instance.rects.size() + size - 1) / size;
+    }
+
+    pipeline::options options;
+    options.first_fit_samples = program.get<unsigned>("--first-fit");
+    options.best_fit_samples = program.get<unsigned>("--best-fit");
+    options.pool_size = options.first_fit_samples + options.best_fit_samples;
+    options.brkga = !program.get<bool>("--no-brkga");
+    options.decoder = program.get("--decoder");
+
+    BRKGA::BrkgaParams brkga_params;
+    BRKGA::ControlParams control_params;
+    if (options.brkga) {
+        std::tie(brkga_params, control_params) =
+            BRKGA::readConfiguration(program.get("--brkga-config"));
+    }
+
+    unsigned max_threads = std::max(1u, program.get<unsigned>("--threads"));
+    std::vector<unsigned> runs = {max_threads};
+    if (program.get<bool>("--scaling")) {
+        runs.clear();
+        for (unsigned t = 1; t < max_threads; t *= 2) {
+            runs.push_back(t);
+        }
+        runs.push_back(max_threads);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Instance: " << instance.rects.size() << " rectangles in "
+              << bands << " bands" << std::endl;
+
+    solution_t solution;
+    double base_time = 0;
+    for (unsigned threads : runs) {
+        std::minstd_rand rng(seed);
+        util::deadline deadline(program.get<double>("--time-limit"));
+        std::vector<decomposition::band_stats> stats;
+        solution = decomposition::solve(instance, bands, key, threads, options,
+                                        brkga_params, control_params, rng,
+                                        deadline, &stats);
+        double elapsed = deadline.elapsed();
+
+        // O paralelismo é a soma dos tempos das faixas pelo tempo total, e a
+        // aceleração é relativa à primeira execução (com uma thread).
+        double band_time = 0;
+        for (const auto& band : stats) {
+            band_time += band.seconds;
+        }
+        if (threads == runs.front()) {
+            base_time = elapsed;
+        }
+
+        std::cout << "Threads: " << threads << ". Time: " << elapsed
+                  << "s. Parallelism: " << band_time / elapsed;
+        if (runs.size() > 1) {
+            std::cout << ". Speedup: " << base_time / elapsed;
+        }
+        std::cout << ". Cost: " << instance.cost(solution) << std::endl;
+    }
+
+    if (auto output = program.present("--output")) {
+        std::ofstream file(*output);
+        file << std::fixed << std::setprecision(3);
+        io::print_solution(file, instance, solution);
+    }
+}
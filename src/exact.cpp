@@ -0,0 +1,120 @@
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include <strip_packing.hpp>
+#include <strip_packing/exact.hpp>
+#include <strip_packing/io.hpp>
+
+#include <argparse/argparse.hpp>
+
+using namespace strip_packing;
+
+/**
+ * Gera uma solução inicial para o branch-and-bound a partir das heurísticas
+ * construtivas aleatorizadas.
+ */
+template <class URBG>
+static void seed_incumbent(exact::branch_and_bound& bnb,
+                           const instance_t& instance, URBG&& rng,
+                           size_t samples) {
+    std::normal_distribution<> noise(0.0, 1.0);
+    for (size_t i = 0; i < samples; i++) {
+        bnb.set_incumbent(
+            heuristics::constructive::randomized_first_fit_decreasing_density(
+                instance, rng, noise));
+        bnb.set_incumbent(
+            heuristics::constructive::randomized_best_fit_increasing_height(
+                instance, rng, noise));
+    }
+}
+
+/*! Ponto de entrada. */
+int main(int argc, char** argv) {
+    argparse::ArgumentParser program("mc859-strip-packing-exact");
+
+    program.add_argument("-s", "--seed")
+        .metavar("N")
+        .help("seed for the random number generator.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("-o", "--output")
+        .metavar("DIR")
+        .default_value<std::string>(".")
+        .help("output directory.");
+
+    program.add_argument("-t", "--threads")
+        .metavar("N")
+        .default_value<unsigned>(std::thread::hardware_concurrency())
+        .help("number of worker threads.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--time-limit")
+        .metavar("SECONDS")
+        .default_value<double>(0)
+        .help("time limit for the search (0 means no limit).")
+        .scan<'g', double>();
+
+    program.add_argument("--samples")
+        .metavar("N")
+        .default_value<unsigned>(100)
+        .help("number of random samples of each constructive heuristic used "
+              "for the initial incumbent.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("file").help("instance file name.");
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << program;
+        std::exit(1);
+    }
+
+    size_t seed;
+    if (auto s = program.present<unsigned>("-s")) {
+        seed = *s;
+    } else {
+        std::random_device rd;
+        seed = rd();
+    }
+
+    instance_t instance;
+    {
+        auto filename = program.get("file");
+        std::ifstream file(filename);
+        instance = io::read_instance(file);
+    }
+
+    std::minstd_rand rng(seed);
+    exact::branch_and_bound bnb(instance);
+    seed_incumbent(bnb, instance, rng, program.get<unsigned>("--samples"));
+
+    auto result = bnb.run(program.get<unsigned>("--threads"),
+                          program.get<double>("--time-limit"));
+
+    std::cout << "Nodes: " << result.nodes << std::endl;
+    std::cout << "Nodes/s: " << result.nodes / std::max(result.elapsed, 1e-9)
+              << std::endl;
+    std::cout << "Time to best: " << result.time_to_best << "s" << std::endl;
+    if (result.optimal) {
+        std::cout << "Time to optimality: " << result.elapsed << "s"
+                  << std::endl;
+    } else {
+        std::cout << "Stopped after " << result.elapsed
+                  << "s without proving optimality (lower bound: "
+                  << result.lower_bound << ")" << std::endl;
+    }
+
+    std::ofstream out(program.get("--output") + "/exact.txt");
+    out << std::fixed << std::setprecision(3);
+    out << "[Branch-and-bound]" << std::endl;
+    out << "Optimal: " << (result.optimal ? "yes" : "no") << std::endl;
+    out << "Lower bound: " << result.lower_bound << std::endl;
+    io::print_solution(out, instance, result.solution);
+}
@@ -1,12 +1,26 @@
-#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
 #include <cstddef>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
 #include <random>
+#include <sstream>
 #include <stdexcept>
+#include <utility>
 
 #include <strip_packing.hpp>
+#include <strip_packing/checkpoint.hpp>
 #include <strip_packing/io.hpp>
+#include <strip_packing/island.hpp>
+#include <strip_packing/pipeline.hpp>
 #include <strip_packing/render.hpp>
+#include <strip_packing/trace.hpp>
+#include <strip_packing/tuning.hpp>
+#include <strip_packing/util/memory.hpp>
+#include <strip_packing/util/perf.hpp>
 
 #include <argparse/argparse.hpp>
 
@@ -14,16 +28,38 @@
 
 using namespace strip_packing;
 
+/*! Flag de cancelamento ativada por SIGINT/SIGTERM. */
+static std::atomic<bool> interrupted(false);
+
+/**
+ * Tratador de sinais de interrupção.
+ *
+ * O primeiro sinal apenas pede que a execução termine com a melhor solução
+ * encontrada até então; um segundo sinal encerra o processo imediatamente.
+ */
+extern "C" void handle_interrupt(int signal) {
+    interrupted.store(true);
+    std::signal(signal, SIG_DFL);
+}
+
 class heuristics_runner {
   public:
     struct config {
         size_t random_seed;
-        bool brkga_enabled;
         std::string brkga_config;
-        size_t first_fit_samples;
-        double first_fit_random_deviations;
-        size_t best_fit_samples;
-        double best_fit_random_deviations;
+        pipeline::options options; /// Fases de solução (veja `pipeline`)
+        bool svg;
+        double time_limit;
+        const std::atomic<bool>* cancel;
+        util::memory::profiler* memory;
+        util::perf::profiler* counters; /// Contadores de hardware (opcional)
+        std::string checkpoint;
+        double checkpoint_interval;
+        std::string resume;
+        std::string trace;
+        std::string progress;
+        std::string island_listen;
+        std::vector<std::string> island_peers;
         std::string output;
     };
 
@@ -31,170 +67,248 @@ class heuristics_runner {
     const instance_t& m_instance;
     const config& m_config;
 
-    double m_weight_stddev;
-    double m_height_stddev;
+    pipeline::solver m_solver; /// Fases de solução
+    std::ofstream m_progress;  /// Registro de progresso (opcional)
 
-    /**
-     * Gera soluções para a instância do problema utilizando a heurística de
-     * first-fit aleatorizada.
-     *
-     * Devolve a melhor solução dentre todas as soluções geradas.
-     */
-    template <class URBG>
-    solution_t run_first_fit(URBG&& rng, size_t samples,
-                             std::vector<solution_t>& solutions) {
-        std::normal_distribution<> noise(
-            0.0, m_config.first_fit_random_deviations * m_weight_stddev);
-        solution_t best;
-        cost_type best_cost = -1;
-        for (size_t i = 0; i < samples; i++) {
-            auto solution = heuristics::constructive::
-                randomized_first_fit_decreasing_density(m_instance, rng, noise);
-            solutions.push_back(solution);
-
-            cost_type cost = m_instance.cost(solution);
-            if (best_cost < 0 || cost < best_cost) {
-                best = solution;
-                best_cost = cost;
-            }
+    /*! Começa uma fase nos registros de memória e de contadores. */
+    void begin_phase(const std::string& phase) {
+        m_config.memory->begin(phase);
+        if (m_config.counters) {
+            m_config.counters->begin(phase);
+        }
+    }
+
+    /*! Termina a fase atual nos registros de memória e de contadores. */
+    void end_phase() {
+        m_config.memory->end();
+        if (m_config.counters) {
+            m_config.counters->end();
         }
-        return best;
     }
 
     /**
-     * Gera soluções para a instância do problema utilizando a heurística de
-     * best-fit aleatorizada.
+     * Melhora soluções utilizando o algoritmo BRKGA-MP-IPR (veja
+     * `pipeline::solver::improve`), com os recursos de execuções longas:
+     * checkpoints, registro de convergência e migração entre processos.
      *
-     * Devolve a melhor solução dentre todas as soluções geradas.
+     * Devolve a melhor solução obtida.
      */
     template <class URBG>
-    solution_t run_best_fit(URBG&& rng, size_t samples,
-                            std::vector<solution_t>& solutions) {
-        std::normal_distribution<> noise(
-            0.0, m_config.best_fit_random_deviations * m_height_stddev);
-        solution_t best;
-        cost_type best_cost = -1;
-        for (size_t i = 0; i < samples; i++) {
-            auto solution =
-                heuristics::constructive::randomized_best_fit_increasing_height(
-                    m_instance, rng, noise);
-            solutions.push_back(solution);
-
-            cost_type cost = m_instance.cost(solution);
-            if (best_cost < 0 || cost < best_cost) {
-                best = solution;
-                best_cost = cost;
-            }
+    solution_t run_brkga(URBG&& rng, const BRKGA::BrkgaParams& brkga_params,
+                         const BRKGA::ControlParams& control_params,
+                         const util::deadline& deadline) {
+        std::unique_ptr<trace::convergence_trace> trace;
+        std::unique_ptr<island::migration> migration;
+        auto solution = m_solver.improve(
+            rng, brkga_params, control_params, deadline,
+            [&](auto& brkga, const BRKGA::BrkgaParams& params) {
+                if (!m_config.checkpoint.empty()) {
+                    brkga.set_checkpoint(m_config.checkpoint,
+                                         m_config.checkpoint_interval);
+                }
+                if (!m_config.resume.empty()) {
+                    brkga.set_warm_start(resume_population(rng, params));
+                }
+                if (!m_config.trace.empty()) {
+                    trace = std::make_unique<trace::convergence_trace>(
+                        m_config.trace);
+                    brkga.set_trace(trace.get());
+                }
+                if (!m_config.island_listen.empty()) {
+                    migration = std::make_unique<island::migration>(
+                        m_config.island_listen, m_config.island_peers,
+                        brkga.chromosome_size());
+                    brkga.set_migration(migration.get());
+                }
+            });
+
+        if (migration) {
+            std::cout << "Migration: sent " << migration->sent()
+                      << " and received " << migration->received()
+                      << " chromosomes" << std::endl;
+        }
+        if (trace && trace->dropped() > 0) {
+            std::cout << "Trace: dropped " << trace->dropped() << " events"
+                      << std::endl;
         }
-        return best;
+        return solution;
     }
 
     /**
-     * Melhora soluções utilizando o algoritmo BRKGA-MP-IPR.
+     * Lê os cromossomos de um checkpoint de uma execução anterior.
      *
-     * Devolve a melhor solução obtida.
+     * Caso o arquivo ainda não exista (por exemplo, na primeira de uma série
+     * de execuções), o algoritmo começa do zero.
      */
     template <class URBG>
-    solution_t run_brkga(URBG&& rng, const BRKGA::BrkgaParams& brkga_params,
-                         const BRKGA::ControlParams& control_params,
-                         std::vector<solution_t>&& initial) {
-        std::shuffle(initial.begin(), initial.end(), rng);
-        return heuristics::improvement::brkga_mp_ipr(m_instance, initial)
-            .run(rng, brkga_params, control_params, 24);
+    std::vector<BRKGA::Chromosome>
+    resume_population(URBG&& rng, const BRKGA::BrkgaParams& brkga_params) {
+        if (!std::ifstream(m_config.resume)) {
+            std::cout << "Checkpoint " << m_config.resume
+                      << " not found, starting from scratch" << std::endl;
+            return {};
+        }
+        auto snapshot = checkpoint::snapshot::load(m_config.resume);
+        auto chromosomes = snapshot.chromosomes(
+            m_instance, rng,
+            size_t(brkga_params.population_size) *
+                brkga_params.num_independent_populations);
+        std::cout << "Resuming from " << chromosomes.size()
+                  << " chromosomes of " << m_config.resume << std::endl;
+        return chromosomes;
     }
 
   public:
     heuristics_runner(const instance_t& instance, const config& conf)
-        : m_instance(instance), m_config(conf) {
-
-        // Computa o desvio padrão do peso e altura dos retângulos, usados para
-        // adicionar perturbações aleatórias nas instâncias para as heurísticas
-        // aleatorizadas.
-        double acc_weight = 0.0;
-        double acc_height = 0.0;
-        for (auto& rect : instance.rects) {
-            acc_weight += rect.weight;
-            acc_height += rect.height;
-        }
-
-        double mean_weight = acc_weight / instance.rects.size();
-        double mean_height = acc_height / instance.rects.size();
-
-        acc_weight = 0.0;
-        acc_height = 0.0;
-        for (auto& rect : instance.rects) {
-            acc_weight += std::pow(rect.weight - mean_weight, 2);
-            acc_height += std::pow(rect.height - mean_height, 2);
+        : m_instance(instance), m_config(conf),
+          m_solver(instance, conf.options, &std::cout) {
+        // Registra o tempo em que uma solução melhor que todas as anteriores
+        // foi encontrada, em qualquer fase (usado para medir o tempo até
+        // atingir um custo alvo).
+        if (!m_config.progress.empty()) {
+            m_progress.open(m_config.progress);
+            m_progress.precision(10);
+            m_progress << "time,cost\n";
+            m_solver.set_progress([this](const pipeline::progress& p) {
+                m_progress << p.time << ',' << p.best << '\n';
+            });
         }
-
-        m_weight_stddev = std::sqrt(acc_weight / instance.rects.size());
-        m_height_stddev = std::sqrt(acc_height / instance.rects.size());
-
-        std::cout << "Weight standard deviation: " << m_weight_stddev
-                  << std::endl;
-        std::cout << "Height standard deviation: " << m_height_stddev
-                  << std::endl;
     }
 
-    /*! Executa as heurísticas. */
+    /**
+     * Executa as heurísticas.
+     *
+     * As fases compartilham um único orçamento de tempo: as heurísticas
+     * construtivas usam no máximo uma fração dele (dividida igualmente entre
+     * elas, veja `pipeline::solver::constructive`), e o BRKGA usa todo o
+     * tempo restante. Quando o prazo expira ou a execução é cancelada, as
+     * fases restantes são puladas e a melhor solução encontrada até então é
+     * escrita.
+     */
     void run() {
         std::ofstream out;
         std::minstd_rand rng(m_config.random_seed);
+        const auto& options = m_config.options;
+
+        // Extensão das figuras (que determina o formato, veja `render`).
+        std::string image = m_config.svg ? ".svg" : ".png";
+
+        util::deadline deadline(m_config.time_limit, m_config.cancel);
+        util::deadline constructive_deadline = deadline.slice(
+            options.brkga ? options.constructive_fraction : 1.0);
 
         out << std::fixed << std::setprecision(3);
         out.open(m_config.output + "/instance.txt");
         io::print_instance(out, m_instance);
         out.close();
 
-        std::vector<solution_t> initial;
-        initial.reserve(m_config.first_fit_samples + m_config.best_fit_samples);
+        begin_phase("constructive");
+        auto [first_fit_solution, best_fit_solution] =
+            m_solver.constructive(rng, constructive_deadline);
+        end_phase();
+
+        if (!first_fit_solution.empty()) {
+            out.open(m_config.output + "/first-fit.txt");
+            out << "[Randomized first-fit decreasing density heuristic "
+                   "solution]"
+                << std::endl;
+            io::print_solution(out, m_instance, first_fit_solution);
+            out.close();
+            util::memory::profiler::scope phase(m_config.memory,
+                                                "render first-fit");
+            util::perf::profiler::scope counted(m_config.counters,
+                                                "render first-fit");
+            render::render_solution(m_instance, first_fit_solution,
+                                    m_config.output + "/first-fit" + image);
+        }
 
-        out.open(m_config.output + "/first-fit.txt");
-        out
-            << "[Randomized first-fit decreasing density heuristic solution]"
-            << std::endl;
-        auto first_fit_solution =
-            run_first_fit(rng, m_config.first_fit_samples, initial);
-        io::print_solution(out, m_instance, first_fit_solution);
-        out.close();
-        render::render_solution(m_instance, first_fit_solution,
-                                m_config.output + "/first-fit.png");
-
-        out.open(m_config.output + "/best-fit.txt");
-        out
-            << "[Randomized best-fit increasing height heuristic solution]"
-            << std::endl;
-        auto best_fit_solution =
-            run_best_fit(rng, m_config.best_fit_samples, initial);
-        io::print_solution(out, m_instance, best_fit_solution);
-        out.close();
-        render::render_solution(m_instance, best_fit_solution,
-                                m_config.output + "/best-fit.png");
+        if (!best_fit_solution.empty()) {
+            out.open(m_config.output + "/best-fit.txt");
+            out << "[Randomized best-fit increasing height heuristic "
+                   "solution]"
+                << std::endl;
+            io::print_solution(out, m_instance, best_fit_solution);
+            out.close();
+            util::memory::profiler::scope phase(m_config.memory,
+                                                "render best-fit");
+            util::perf::profiler::scope counted(m_config.counters,
+                                                "render best-fit");
+            render::render_solution(m_instance, best_fit_solution,
+                                    m_config.output + "/best-fit" + image);
+        }
 
-        if (m_config.brkga_enabled) {
+        if (options.brkga && !deadline.expired()) {
+            begin_phase("brkga");
             out.open(m_config.output + "/brkga.txt");
             out << "[BRKGA]" << std::endl;
             auto [brkga_params, control_params] =
                 BRKGA::readConfiguration(m_config.brkga_config);
-
-            // Garante que cada população seja composta inicialmente por, no
-            // máximo, 50% de soluções heurísticas.
-            brkga_params.population_size =
-                std::max(brkga_params.population_size,
-                         unsigned(m_config.best_fit_samples +
-                                  m_config.first_fit_samples) *
-                             2 / brkga_params.num_independent_populations);
-
-            auto brkga_solution = run_brkga(rng, brkga_params, control_params,
-                                            std::move(initial));
+            auto brkga_solution =
+                run_brkga(rng, brkga_params, control_params, deadline);
+            end_phase();
+            m_solver.offer(brkga_solution);
             io::print_solution(out, m_instance, brkga_solution);
             out.close();
+            util::memory::profiler::scope phase(m_config.memory,
+                                                "render brkga");
+            util::perf::profiler::scope counted(m_config.counters,
+                                                "render brkga");
             render::render_solution(m_instance, brkga_solution,
-                                    m_config.output + "/brkga.png");
+                                    m_config.output + "/brkga" + image);
+        }
+
+        if (deadline.cancelled()) {
+            std::cout << "Interrupted after " << deadline.elapsed() << "s"
+                      << std::endl;
+        }
+
+        out.open(m_config.output + "/best.txt");
+        out << "[Best solution]" << std::endl;
+        io::print_solution(out, m_instance, m_solver.best());
+        out.close();
+
+        out.open(m_config.output + "/memory.txt");
+        m_config.memory->write(out);
+        out.close();
+
+        if (m_config.counters) {
+            out.open(m_config.output + "/counters.txt");
+            m_config.counters->write(out);
+            out.close();
         }
     }
 };
 
+/*! Separa uma string em partes não vazias por um delimitador. */
+static std::vector<std::string> split(const std::string& str, char delim) {
+    std::vector<std::string> parts;
+    std::stringstream stream(str);
+    std::string part;
+    while (std::getline(stream, part, delim)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+/**
+ * Valor de uma opção, ou da configuração ajustada, caso ela defina a opção e
+ * a opção não tenha sido dada explicitamente.
+ */
+template <typename T>
+static T tuned_option(const argparse::ArgumentParser& program,
+                      const std::map<std::string, std::string>& tuned,
+                      const std::string& flag, const std::string& key) {
+    auto it = tuned.find(key);
+    if (program.is_used(flag) || it == tuned.end()) {
+        return program.get<T>(flag);
+    }
+    T value;
+    std::istringstream(it->second) >> value;
+    return value;
+}
+
 /*! Ponto de entrada. */
 int main(int argc, char** argv) {
     argparse::ArgumentParser program("mc859-strip-packing-heuristics");
@@ -220,6 +334,70 @@ int main(int argc, char** argv) {
         .metavar("FILE")
         .help("BRKGA configuration file.");
 
+    program.add_argument("--tuned-dir")
+        .default_value<std::string>("tuned")
+        .metavar("DIR")
+        .help("directory with the tuned configurations of each instance class "
+              "(see mc859-strip-packing-tune), used when --brkga-config is not "
+              "given.");
+
+    program.add_argument("--no-tuned")
+        .default_value(false)
+        .implicit_value(true)
+        .help("ignore the tuned configurations.")
+        .nargs(0);
+
+    program.add_argument("--decoder")
+        .default_value<std::string>("next-fit")
+        .metavar("NAME")
+        .help("BRKGA chromosome decoder (next-fit, first-fit, best-fit or "
+              "height-fit).");
+
+    program.add_argument("--bounded-decode")
+        .default_value(false)
+        .implicit_value(true)
+        .help("stop decoding chromosomes that cannot reach the elite "
+              "(next-fit decoder only).")
+        .nargs(0);
+
+    program.add_argument("--no-reorder-levels")
+        .default_value(false)
+        .implicit_value(true)
+        .help("disable the optimal reordering of the levels of the solutions "
+              "(Smith's rule).")
+        .nargs(0);
+
+    program.add_argument("--intensify")
+        .default_value<unsigned>(0)
+        .metavar("N")
+        .help("number of local search threads cooperating with the BRKGA.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--adaptive")
+        .default_value(false)
+        .implicit_value(true)
+        .help("size the BRKGA populations to the time budget and adapt the "
+              "mutation rate, shaking intensity and path relinking interval "
+              "to the rate of improvement during the run.")
+        .nargs(0);
+
+    program.add_argument("--perf-counters")
+        .default_value(false)
+        .implicit_value(true)
+        .help("collect hardware performance counters (cycles, instructions, "
+              "cache misses and branch misses) per phase, summed over all "
+              "threads, and write them to counters.txt.")
+        .nargs(0);
+
+    program.add_argument("--trace")
+        .metavar("FILE")
+        .help("write a CSV trace of the BRKGA convergence.");
+
+    program.add_argument("--progress")
+        .metavar("FILE")
+        .help("write a CSV with the time of each improvement of the best "
+              "solution, across all phases.");
+
     program.add_argument("--first-fit")
         .default_value<unsigned>(500)
         .metavar("N")
@@ -246,10 +424,109 @@ int main(int argc, char** argv) {
               "heuristic.")
         .scan<'g', double>();
 
+    program.add_argument("--heuristics")
+        .default_value<std::string>("")
+        .metavar("NAMES")
+        .help("comma-separated additional constructive heuristics to sample, "
+              "each named FIT/ORDER/NOISE (fit: next-fit, first-fit, best-fit "
+              "or height-fit; order: density, increasing-height, "
+              "decreasing-height or weight; noise: none, weight or height).");
+
+    program.add_argument("--heuristic-samples")
+        .default_value<unsigned>(500)
+        .metavar("N")
+        .help("number of random samples of each additional heuristic.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--heuristic-deviations")
+        .default_value<double>(.25)
+        .metavar("N")
+        .help("standard deviations to use for randomization of the "
+              "additional heuristics.")
+        .scan<'g', double>();
+
+    program.add_argument("--portfolio")
+        .default_value(false)
+        .implicit_value(true)
+        .help("spread the first fit and best fit samples adaptively among "
+              "the heuristics and noise levels that are producing the best "
+              "solutions.")
+        .nargs(0);
+
+    program.add_argument("--svg")
+        .default_value(false)
+        .implicit_value(true)
+        .help("draw the solutions as SVG files instead of PNG images.")
+        .nargs(0);
+
+    program.add_argument("--compress")
+        .default_value(false)
+        .implicit_value(true)
+        .help("group identical rectangles into classes in the constructive "
+              "heuristics.")
+        .nargs(0);
+
+    program.add_argument("--threads")
+        .default_value<unsigned>(1)
+        .metavar("N")
+        .help("number of threads used by the constructive portfolio.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--pool-size")
+        .default_value<unsigned>(1000)
+        .metavar("N")
+        .help("maximum number of distinct heuristic solutions kept for the "
+              "initial BRKGA population.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--time-limit")
+        .default_value<double>(0)
+        .metavar("SECONDS")
+        .help("wall-clock budget shared by all phases (0 means no limit).")
+        .scan<'g', double>();
+
+    program.add_argument("--checkpoint")
+        .metavar("FILE")
+        .help("write BRKGA populations to a checkpoint file periodically and "
+              "on exit.");
+
+    program.add_argument("--checkpoint-interval")
+        .default_value<double>(60)
+        .metavar("SECONDS")
+        .help("interval between checkpoints.")
+        .scan<'g', double>();
+
+    program.add_argument("--resume")
+        .metavar("FILE")
+        .help("warm-start BRKGA populations from a checkpoint file.");
+
+    program.add_argument("--island-listen")
+        .metavar("ENDPOINT")
+        .help("enable the distributed island mode, listening for migrants on "
+              "ENDPOINT (host:port or unix:path).");
+
+    program.add_argument("--island-peers")
+        .default_value<std::string>("")
+        .metavar("ENDPOINTS")
+        .help("comma-separated endpoints of the other islands.");
+
     program.add_argument("file").help("instance file name.");
 
     try {
         program.parse_args(argc, argv);
+
+        auto decoder = program.get("--decoder");
+        const auto& fits = heuristics::constructive::fit_names;
+        if (std::find(fits.begin(), fits.end(), decoder) == fits.end()) {
+            throw std::runtime_error("Invalid decoder: " + decoder);
+        }
+
+        auto names = heuristics::constructive::heuristic_names();
+        for (const auto& name : split(program.get("--heuristics"), ',')) {
+            if (std::find(names.begin(), names.end(), name) == names.end()) {
+                throw std::runtime_error("Invalid heuristic: " + name);
+            }
+        }
     } catch (const std::runtime_error& err) {
         std::cerr << err.what() << std::endl;
         std::cerr << program;
@@ -264,24 +541,99 @@ int main(int argc, char** argv) {
         seed = rd();
     }
 
+    // O uso de memória é registrado por fase, da leitura da instância à
+    // escrita das soluções (veja `util::memory`).
+    util::memory::profiler memory;
+    memory.begin("parse");
+
+    // Os contadores de hardware são abertos antes de qualquer thread ser
+    // criada, para que as contagens delas sejam somadas (veja `util::perf`).
+    std::optional<util::perf::profiler> counters;
+    if (program.get<bool>("--perf-counters")) {
+        counters.emplace();
+        if (!counters->source().any()) {
+            std::cout << "Hardware counters unavailable ("
+                      << counters->source().error() << ")" << std::endl;
+        }
+        counters->begin("parse");
+    }
+
     instance_t instance;
     {
         auto filename = program.get("file");
         std::ifstream file(filename);
         instance = io::read_instance(file);
     }
+    memory.end();
+    if (counters) {
+        counters->end();
+    }
+
+    // Sem uma configuração do BRKGA explícita, usa a configuração ajustada
+    // para a classe da instância, caso exista.
+    std::string brkga_config = program.get("--brkga-config");
+    std::map<std::string, std::string> tuned;
+    if (!program.get<bool>("--no-tuned") &&
+        !program.is_used("--brkga-config")) {
+        auto filename = program.get("--tuned-dir") + "/" +
+                        tuning::instance_class(instance) + ".conf";
+        if (std::ifstream(filename)) {
+            brkga_config = filename;
+            tuned = tuning::read_runner_options(filename);
+            std::cout << "Using tuned configuration " << filename
+                      << std::endl;
+        }
+    }
+
+    pipeline::options options;
+    options.brkga = !program.get<bool>("--no-brkga");
+    options.first_fit_samples = tuned_option<unsigned>(
+        program, tuned, "--first-fit", "first_fit_samples");
+    options.first_fit_deviations = tuned_option<double>(
+        program, tuned, "--first-fit-deviations", "first_fit_deviations");
+    options.best_fit_samples = tuned_option<unsigned>(
+        program, tuned, "--best-fit", "best_fit_samples");
+    options.best_fit_deviations = tuned_option<double>(
+        program, tuned, "--best-fit-deviations", "best_fit_deviations");
+    options.heuristics = split(program.get("--heuristics"), ',');
+    options.heuristic_samples = program.get<unsigned>("--heuristic-samples");
+    options.heuristic_deviations =
+        program.get<double>("--heuristic-deviations");
+    options.portfolio = program.get<bool>("--portfolio");
+    options.compress = program.get<bool>("--compress");
+    options.threads = program.get<unsigned>("--threads");
+    options.pool_size = program.get<unsigned>("--pool-size");
+    options.decoder = program.get("--decoder");
+    options.bounded_decode = program.get<bool>("--bounded-decode");
+    options.reorder_levels = !program.get<bool>("--no-reorder-levels");
+    options.intensify = program.get<unsigned>("--intensify");
+    options.adaptive = program.get<bool>("--adaptive");
+    options.brkga_threads = 24;
 
     heuristics_runner::config conf = {
         .random_seed = seed,
-        .brkga_enabled = !program.get<bool>("--no-brkga"),
-        .brkga_config = program.get("--brkga-config"),
-        .first_fit_samples = program.get<unsigned>("--first-fit"),
-        .first_fit_random_deviations =
-            program.get<double>("--first-fit-deviations"),
-        .best_fit_samples = program.get<unsigned>("--best-fit"),
-        .best_fit_random_deviations =
-            program.get<double>("--best-fit-deviations"),
+        .brkga_config = brkga_config,
+        .options = options,
+        .svg = program.get<bool>("--svg"),
+        .time_limit = program.get<double>("--time-limit"),
+        .cancel = &interrupted,
+        .memory = &memory,
+        .counters = counters ? &*counters : nullptr,
+        .checkpoint = program.present("--checkpoint").value_or(""),
+        .checkpoint_interval = program.get<double>("--checkpoint-interval"),
+        .resume = program.present("--resume").value_or(""),
+        .trace = program.present("--trace").value_or(""),
+        .progress = program.present("--progress").value_or(""),
+        .island_listen = program.present("--island-listen").value_or(""),
+        .island_peers = split(program.get("--island-peers"), ','),
         .output = program.get("--output")};
 
+    std::signal(SIGINT, handle_interrupt);
+    std::signal(SIGTERM, handle_interrupt);
+
+    memory.begin("setup");
+    if (counters) {
+        counters->begin("setup");
+    }
     heuristics_runner(instance, conf).run();
 }
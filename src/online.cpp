@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <strip_packing.hpp>
+#include <strip_packing/io.hpp>
+#include <strip_packing/online.hpp>
+
+#include <argparse/argparse.hpp>
+
+using namespace strip_packing;
+
+/**
+ * Reproduz uma instância como uma sequência de chegadas de retângulos,
+ * inserindo-os um a um em um `online::packer`, e reporta a latência das
+ * inserções e o custo final.
+ */
+int main(int argc, char** argv) {
+    argparse::ArgumentParser program("mc859-strip-packing-online");
+
+    program.add_argument("-s", "--seed")
+        .metavar("N")
+        .help("seed for the random number generator.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("-r", "--rate")
+        .default_value<double>(0)
+        .metavar("N")
+        .help("arrivals per second (0 means as fast as possible).")
+        .scan<'g', double>();
+
+    program.add_argument("--interval")
+        .default_value<unsigned>(50)
+        .metavar("MS")
+        .help("interval between window re-optimizations (0 disables them).")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--window")
+        .default_value<unsigned>(16)
+        .metavar("N")
+        .help("number of most recent levels re-optimized.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--samples")
+        .default_value<unsigned>(20)
+        .metavar("N")
+        .help("random samples of each heuristic per re-optimization.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("-o", "--output")
+        .metavar("FILE")
+        .help("write the final solution to a file.");
+
+    program.add_argument("file").help("instance file name.");
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << program;
+        std::exit(1);
+    }
+
+    instance_t instance;
+    {
+        std::ifstream file(program.get("file"));
+        instance = io::read_instance(file);
+    }
+
+    unsigned seed;
+    if (auto s = program.present<unsigned>("-s")) {
+        seed = *s;
+    } else {
+        std::random_device rd;
+        seed = rd();
+    }
+
+    online::packer packer(instance.recipient_length);
+    if (auto interval = program.get<unsigned>("--interval")) {
+        packer.start(std::chrono::milliseconds(interval),
+                     program.get<unsigned>("--window"),
+                     program.get<unsigned>("--samples"), seed);
+    }
+
+    using clock = std::chrono::steady_clock;
+    double rate = program.get<double>("--rate");
+    std::vector<double> latencies;
+    latencies.reserve(instance.rects.size());
+
+    auto start = clock::now();
+    for (size_t i = 0; i < instance.rects.size(); i++) {
+        if (rate > 0) {
+            std::this_thread::sleep_until(
+                start + std::chrono::duration_cast<clock::duration>(
+                            std::chrono::duration<double>(i / rate)));
+        }
+        auto before = clock::now();
+        packer.insert(instance.rects[i]);
+        std::chrono::duration<double, std::micro> elapsed =
+            clock::now() - before;
+        latencies.push_back(elapsed.count());
+    }
+    std::chrono::duration<double> total = clock::now() - start;
+    packer.stop();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        return latencies[size_t(p * (latencies.size() - 1))];
+    };
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Inserted " << latencies.size() << " rectangles in "
+              << total.count() << "s" << std::endl;
+    std::cout << "Latency (us): p50 " << percentile(.5) << ", p99 "
+              << percentile(.99) << ", max " << percentile(1) << std::endl;
+    std::cout << "Re-optimizations: " << packer.improvements() << " of "
+              << packer.reoptimizations() << " applied" << std::endl;
+    std::cout << "Cost: " << packer.cost() << std::endl;
+
+    if (auto output = program.present("--output")) {
+        std::ofstream file(*output);
+        file << std::fixed << std::setprecision(3);
+        io::print_solution(file, packer.instance(), packer.solution());
+    }
+}
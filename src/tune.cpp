@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <strip_packing.hpp>
+#include <strip_packing/io.hpp>
+#include <strip_packing/pipeline.hpp>
+#include <strip_packing/tuning.hpp>
+#include <strip_packing/util/deadline.hpp>
+#include <strip_packing/util/worker_pool.hpp>
+
+#include <argparse/argparse.hpp>
+
+#include <brkga_mp_ipr/brkga_mp_ipr.hpp>
+
+using namespace strip_packing;
+
+/*! Instância de treino. */
+struct training_instance {
+    std::string name;
+    instance_t instance;
+};
+
+/**
+ * Avalia as candidatas restantes de uma corrida em um bloco (uma instância e
+ * uma semente), em paralelo, e devolve o custo de cada uma, na ordem de
+ * `race.alive()`.
+ */
+static std::vector<double>
+run_block(util::worker_pool& workers,
+          const std::vector<tuning::configuration>& candidates,
+          const tuning::race& race, const instance_t& instance,
+          unsigned seed, double time_limit) {
+    const auto& alive = race.alive();
+    std::vector<double> costs(alive.size());
+
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining = alive.size();
+    std::exception_ptr error; /// Primeira falha de uma corrida
+    for (size_t j = 0; j < alive.size(); j++) {
+        workers.submit([&, j] {
+            // Toda corrida é contada, mesmo que falhe, para que a espera
+            // abaixo sempre termine; a falha é relançada depois dela.
+            std::exception_ptr failure;
+            try {
+                const auto& c = candidates[alive[j]];
+                std::minstd_rand rng(seed);
+                auto solution =
+                    pipeline::solve(instance, c.options, c.brkga, c.control,
+                                    rng, util::deadline(time_limit));
+                costs[j] = instance.cost(solution);
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failure && !error) {
+                error = failure;
+            }
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return remaining == 0; });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return costs;
+}
+
+/**
+ * Ajusta os parâmetros por corridas (veja `tuning::race`) sobre um conjunto
+ * de instâncias de treino, separadamente para cada classe de instância, e
+ * escreve a melhor configuração de cada classe em DIR/<classe>.conf, onde o
+ * executável de heurísticas a encontra.
+ */
+int main(int argc, char** argv) {
+    argparse::ArgumentParser program("mc859-strip-packing-tune");
+
+    program.add_argument("-s", "--seed")
+        .metavar("N")
+        .help("seed for the random number generator.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("-o", "--output")
+        .metavar("DIR")
+        .default_value<std::string>("tuned")
+        .help("directory where the tuned configuration of each instance "
+              "class is written.");
+
+    program.add_argument("--brkga-config")
+        .default_value<std::string>("brkga.conf")
+        .metavar("FILE")
+        .help("base BRKGA configuration, raced against the sampled "
+              "candidates.");
+
+    program.add_argument("--candidates")
+        .default_value<unsigned>(16)
+        .metavar("N")
+        .help("number of candidate configurations, including the base one.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--experiments")
+        .default_value<unsigned>(200)
+        .metavar("N")
+        .help("maximum number of runs per instance class.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--time-limit")
+        .default_value<double>(10)
+        .metavar("SECONDS")
+        .help("wall-clock budget of each run.")
+        .scan<'g', double>();
+
+    program.add_argument("--alpha")
+        .default_value<double>(0.05)
+        .metavar("P")
+        .help("significance level of the Friedman test.")
+        .scan<'g', double>();
+
+    program.add_argument("--first-test")
+        .default_value<unsigned>(5)
+        .metavar("N")
+        .help("number of blocks (instance and seed) before the first test.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("--threads")
+        .default_value<unsigned>(std::thread::hardware_concurrency())
+        .metavar("N")
+        .help("number of runs executed in parallel.")
+        .scan<'u', unsigned>();
+
+    program.add_argument("files")
+        .help("training instance files.")
+        .remaining();
+
+    std::vector<std::string> files;
+    try {
+        program.parse_args(argc, argv);
+        files = program.get<std::vector<std::string>>("files");
+    } catch (const std::exception& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << program;
+        std::exit(1);
+    }
+
+    std::mt19937 rng;
+    if (auto s = program.present<unsigned>("-s")) {
+        rng.seed(*s);
+    } else {
+        rng.seed(std::random_device()());
+    }
+
+    tuning::configuration base;
+    std::tie(base.brkga, base.control) =
+        BRKGA::readConfiguration(program.get("--brkga-config"));
+
+    std::map<std::string, std::vector<training_instance>> classes;
+    for (const auto& filename : files) {
+        std::ifstream file(filename);
+        instance_t instance = io::read_instance(file);
+        classes[tuning::instance_class(instance)].push_back(
+            {std::filesystem::path(filename).stem(), std::move(instance)});
+    }
+
+    auto output = program.get("--output");
+    std::filesystem::create_directories(output);
+
+    unsigned candidates_count =
+        std::max(1u, program.get<unsigned>("--candidates"));
+    unsigned experiments = program.get<unsigned>("--experiments");
+    double time_limit = program.get<double>("--time-limit");
+    util::worker_pool workers(program.get<unsigned>("--threads"));
+
+    for (auto& [name, training] : classes) {
+        std::cout << "Class " << name << ": " << training.size()
+                  << " instances" << std::endl;
+        std::shuffle(training.begin(), training.end(), rng);
+
+        std::vector<tuning::configuration> candidates = {base};
+        while (candidates.size() < candidates_count) {
+            candidates.push_back(tuning::sample(base, rng));
+        }
+
+        tuning::race race(candidates.size(), program.get<double>("--alpha"),
+                          program.get<unsigned>("--first-test"));
+        size_t used = 0;
+        while (race.alive().size() > 1 &&
+               used + race.alive().size() <= experiments) {
+            const auto& block = training[race.blocks() % training.size()];
+            unsigned seed = rng();
+            used += race.alive().size();
+            race.add_block(run_block(workers, candidates, race,
+                                     block.instance, seed, time_limit));
+            std::cout << "  Block " << race.blocks() << " (" << block.name
+                      << ", seed " << seed << "): " << race.alive().size()
+                      << " candidates alive" << std::endl;
+        }
+
+        size_t best = race.best();
+        auto filename = output + "/" + name + ".conf";
+        tuning::save(filename, candidates[best]);
+        std::cout << "  Best candidate " << best
+                  << (best == 0 ? " (base configuration)" : "") << " after "
+                  << used << " runs, written to " << filename << std::endl;
+    }
+}